@@ -0,0 +1,190 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <variant>
+#include <vector>
+
+//
+// Classic bridge (two virtual calls and a pointer chase per operation)
+
+namespace dynamic {
+
+struct Implementor
+{
+  virtual ~Implementor() = default;
+
+  virtual long operation_impl(long x) const = 0;
+};
+
+struct ConcreteImplementorA : public Implementor
+{
+  long operation_impl(long x) const override { return x + 1; }
+};
+
+struct ConcreteImplementorB : public Implementor
+{
+  long operation_impl(long x) const override { return x * 3; }
+};
+
+struct Abstraction
+{
+  Abstraction(std::unique_ptr<Implementor> impl)
+  : pimpl{std::move(impl)} { }
+
+  virtual ~Abstraction() = default;
+
+  virtual long operation(long x) const = 0;
+
+protected:
+  std::unique_ptr<Implementor> pimpl; // Bridge
+};
+
+struct RefinedAbstractionA : public Abstraction
+{
+  RefinedAbstractionA(std::unique_ptr<Implementor> impl)
+  : Abstraction(std::move(impl)) { }
+
+  long operation(long x) const override {
+    return pimpl->operation_impl(x) * 2;
+  }
+};
+
+} // namespace dynamic
+
+//
+// Devirtualized bridge (implementor stored inline)
+
+// Implementors form a closed set and share no base class
+struct ConcreteImplementorA
+{
+  long operation_impl(long x) const { return x + 1; }
+};
+
+struct ConcreteImplementorB
+{
+  long operation_impl(long x) const { return x * 3; }
+};
+
+// Forward to an implementor known at compile time
+template <class Impl>
+long forward_impl(Impl const& impl, long x)
+{
+  return impl.operation_impl(x);
+}
+
+// Forward to an implementor selected at runtime from a closed set
+template <class... Impls>
+long forward_impl(std::variant<Impls...> const& impl, long x)
+{
+  return std::visit([x](auto const& i) { return i.operation_impl(x); }, impl);
+}
+
+// The Abstraction owns its implementor by value, which is either a
+// single concrete type (template parameter) or a std::variant of them
+template <class Impl>
+struct Abstraction
+{
+  Abstraction(Impl impl)
+  : impl{std::move(impl)} { }
+
+  // Runtime swapping is available when Impl is a std::variant
+  void set_implementor(Impl i) { impl = std::move(i); }
+
+protected:
+  Impl impl; // Bridge
+};
+
+template <class Impl>
+struct RefinedAbstractionA : public Abstraction<Impl>
+{
+  using Abstraction<Impl>::Abstraction;
+
+  long operation(long x) const {
+    return forward_impl(this->impl, x) * 2;
+  }
+};
+
+using Implementor = std::variant<ConcreteImplementorA, ConcreteImplementorB>;
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+template <class A>
+long call_loop(A const& a, std::vector<long> const& input, int reps)
+{
+  long acc = 0;
+  for (int r = 0; r < reps; ++r)
+    for (long x : input)
+      acc += a.operation(x);
+  return acc;
+}
+
+int main(int argc, char**)
+{
+  // Choose the implementor at runtime so that the compiler
+  // cannot devirtualize the classic bridge
+  bool use_b = argc > 1;
+
+  // Client usage
+  RefinedAbstractionA<ConcreteImplementorA> static_bridge{{}};
+  RefinedAbstractionA<Implementor>          variant_bridge{ConcreteImplementorA{}};
+
+  std::cout << "static_bridge.operation(1)  = " << static_bridge.operation(1)  << std::endl;
+  std::cout << "variant_bridge.operation(1) = " << variant_bridge.operation(1) << std::endl;
+
+  variant_bridge.set_implementor(ConcreteImplementorB{});
+  std::cout << "variant_bridge.operation(1) = " << variant_bridge.operation(1)
+            << " (after swapping to ConcreteImplementorB)" << std::endl;
+
+  // Benchmark the call overhead of each design
+  std::vector<long> input(1 << 16);
+  for (std::size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<long>(i * 7919 % 1000);
+
+  int  const reps = 2'000;
+  long const n    = static_cast<long>(input.size()) * reps;
+
+  std::unique_ptr<dynamic::Implementor> impl;
+  if (use_b)
+    impl = std::make_unique<dynamic::ConcreteImplementorB>();
+  else
+    impl = std::make_unique<dynamic::ConcreteImplementorA>();
+
+  std::unique_ptr<dynamic::Abstraction> virtual_bridge
+    = std::make_unique<dynamic::RefinedAbstractionA>(std::move(impl));
+
+  if (use_b)
+    variant_bridge.set_implementor(ConcreteImplementorB{});
+  else
+    variant_bridge.set_implementor(ConcreteImplementorA{});
+
+  // The template bridge fixes its implementor at compile time, so both
+  // instantiations exist and the branch is taken outside the timed loop
+  RefinedAbstractionA<ConcreteImplementorB> static_bridge_b{{}};
+
+  long r1{}, r2{}, r3{};
+  double t1 = time_ms([&] { r1 = call_loop(*virtual_bridge, input, reps); });
+  double t2 = time_ms([&] { r2 = call_loop(variant_bridge, input, reps); });
+  double t3 = use_b ? time_ms([&] { r3 = call_loop(static_bridge_b, input, reps); })
+                    : time_ms([&] { r3 = call_loop(static_bridge, input, reps);   });
+
+  std::cout << "\nBenchmark: " << n << " calls to operation()"
+            << "\nvirtual  (unique_ptr): " << t1 << " ms  (" << t1 * 1e6 / n << " ns/call)"
+            << "\nvariant  (std::visit): " << t2 << " ms  (" << t2 * 1e6 / n << " ns/call)"
+            << "\ntemplate (inline):     " << t3 << " ms  (" << t3 * 1e6 / n << " ns/call)"
+            << "\nchecksums: " << r1 << " " << r2 << " " << r3 << std::endl;
+
+  // Inlining: compile with -O2 -fopt-info-inline-optimized to confirm that
+  // operation_impl is inlined into call_loop for the template and variant
+  // bridges, while the virtual bridge keeps both indirect calls in the loop.
+}
@@ -0,0 +1,268 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+//
+// Pointer-based composite (one make_unique per node)
+
+namespace pointer {
+
+struct Component
+{
+  virtual ~Component() = default;
+
+  virtual long operation() const = 0;
+  virtual void add(std::unique_ptr<Component> component) { }
+};
+
+struct Leaf : public Component
+{
+  Leaf(long v) : value{v} { }
+
+  long operation() const override { return value; }
+
+private:
+  long value;
+};
+
+struct Composite : public Component
+{
+  long operation() const override {
+    long sum = 0;
+    for (const auto& child : children)
+      sum += child->operation();
+    return sum;
+  }
+
+  void add(std::unique_ptr<Component> component) override {
+    children.push_back(std::move(component));
+  }
+
+private:
+  std::vector<std::unique_ptr<Component>> children;
+};
+
+} // namespace pointer
+
+//
+// Arena
+
+// Types whose destructor must run when the arena is torn down opt in here.
+// Everything else is simply abandoned: its storage is released in bulk.
+template <class T>
+inline constexpr bool arena_destroy = false;
+
+// Bump-allocates objects from a monotonic resource and frees them all at
+// once. Destructors are only run for types that opted in, in reverse
+// order of construction.
+class Arena {
+public:
+  explicit Arena(std::size_t initial_size = 64 * 1024)
+  : resource{initial_size} { }
+
+  ~Arena() {
+    for (Destructor* d = dtors; d != nullptr; d = d->next)
+      d->destroy(d->object);
+    // resource releases every block here
+  }
+
+  Arena(Arena const&)            = delete;
+  Arena& operator=(Arena const&) = delete;
+
+  template <class T, class... Args>
+  T* make(Args&&... args) {
+    // Reserve the bookkeeping first so that registration cannot fail
+    // after the object has been constructed
+    Destructor* d = nullptr;
+    if constexpr (arena_destroy<T>)
+      d = static_cast<Destructor*>(resource.allocate(sizeof(Destructor), alignof(Destructor)));
+
+    void* p = resource.allocate(sizeof(T), alignof(T));
+    T* obj = ::new (p) T(std::forward<Args>(args)...);
+
+    if constexpr (arena_destroy<T>) {
+      d->destroy = [](void* o) { static_cast<T*>(o)->~T(); };
+      d->object  = obj;
+      d->next    = dtors;
+      dtors      = d;
+    }
+    return obj;
+  }
+
+  std::pmr::memory_resource* get_resource() { return &resource; }
+
+private:
+  struct Destructor {
+    void      (*destroy)(void*);
+    void*       object;
+    Destructor* next;
+  };
+
+  std::pmr::monotonic_buffer_resource resource;
+  Destructor* dtors{nullptr};
+};
+
+//
+// Arena-owned composite (nodes are non-owning views into the arena)
+
+struct Component
+{
+  virtual ~Component() = default;
+
+  virtual long operation() const = 0;
+  virtual void add(Component* component) { }
+  virtual void remove(Component* component) { }
+  virtual Component* get_child(std::size_t index) const { return nullptr; }
+};
+
+struct Leaf : public Component
+{
+  Leaf(long v) : value{v} { }
+
+  long operation() const override { return value; }
+
+private:
+  long value;
+};
+
+// A leaf with state outside the arena, so its destructor must run
+struct NamedLeaf : public Component
+{
+  NamedLeaf(std::string n) : name{std::move(n)} { }
+
+  long operation() const override { return static_cast<long>(name.size()); }
+
+private:
+  std::string name;
+};
+
+template <>
+inline constexpr bool arena_destroy<NamedLeaf> = true;
+
+// The child list draws from the arena too, so skipping ~Composite is safe
+struct Composite : public Component
+{
+  Composite(std::pmr::memory_resource* r)
+  : children{r} { }
+
+  long operation() const override {
+    long sum = 0;
+    for (const auto* child : children)
+      sum += child->operation();
+    return sum;
+  }
+
+  void add(Component* component) override {
+    children.push_back(component);
+  }
+
+  // Unlinks the child; its storage is reclaimed with the arena
+  void remove(Component* component) override {
+    auto it = std::find(children.begin(), children.end(), component);
+    if (it != children.end())
+      children.erase(it);
+  }
+
+  Component* get_child(std::size_t index) const override {
+    if (index < children.size())
+      return children[index];
+
+    return nullptr;
+  }
+
+private:
+  std::pmr::vector<Component*> children;
+};
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main()
+{
+  // Client usage
+  {
+    Arena arena;
+    Component* composite = arena.make<Composite>(arena.get_resource());
+    composite->add(arena.make<Leaf>(1));
+    composite->add(arena.make<NamedLeaf>("a name too long for the small string buffer"));
+
+    std::cout << "Composite::operation: " << composite->operation() << std::endl;
+  } // One bulk release, plus ~NamedLeaf
+
+  // Benchmark: width composites of width leaves each
+  std::size_t const width = 1'000;
+
+  auto ptree = std::make_unique<pointer::Composite>();
+  double build_p = time_ms([&] {
+    for (std::size_t c = 0; c < width; ++c) {
+      auto group = std::make_unique<pointer::Composite>();
+      for (std::size_t l = 0; l < width; ++l)
+        group->add(std::make_unique<pointer::Leaf>(static_cast<long>(l)));
+      ptree->add(std::move(group));
+    }
+  });
+  long sum_p = ptree->operation();
+  double teardown_p = time_ms([&] { ptree.reset(); });
+
+  // every_named: one in every_named leaves is a NamedLeaf (0 means none)
+  auto arena_run = [&](char const* name, std::size_t every_named) {
+    auto arena = std::make_unique<Arena>(1 << 20);
+    Component* root = nullptr;
+    double build = time_ms([&] {
+      root = arena->make<Composite>(arena->get_resource());
+      for (std::size_t c = 0; c < width; ++c) {
+        Component* group = arena->make<Composite>(arena->get_resource());
+        for (std::size_t l = 0; l < width; ++l) {
+          if (every_named != 0 and l % every_named == 0)
+            group->add(arena->make<NamedLeaf>(std::string(32, 'x')));
+          else
+            group->add(arena->make<Leaf>(static_cast<long>(l)));
+        }
+        root->add(group);
+      }
+    });
+    long sum = root->operation();
+    double teardown = time_ms([&] { arena.reset(); });
+
+    std::cout << name << " build: " << build << " ms, teardown: " << teardown
+              << " ms (checksum " << sum << ")" << std::endl;
+  };
+
+  std::cout << "\nBenchmark: " << width * width << " leaves"
+            << "\npointer        build: " << build_p << " ms, teardown: " << teardown_p
+            << " ms (checksum " << sum_p << ")" << std::endl;
+  arena_run("arena         ", 0);
+  arena_run("arena 10% dtor", 10);
+
+  // A degenerate chain is torn down without recursion, whereas the
+  // recursive unique_ptr teardown of the same chain can exhaust the stack
+  std::size_t const depth = 1'000'000;
+  auto arena = std::make_unique<Arena>(1 << 20);
+  double build_chain = time_ms([&] {
+    Component* link = arena->make<Composite>(arena->get_resource());
+    for (std::size_t d = 0; d < depth; ++d) {
+      Component* next = arena->make<Composite>(arena->get_resource());
+      link->add(next);
+      link = next;
+    }
+  });
+  double teardown_chain = time_ms([&] { arena.reset(); });
+  std::cout << "arena chain of depth " << depth << " build: " << build_chain
+            << " ms, teardown: " << teardown_chain << " ms" << std::endl;
+}
@@ -0,0 +1,338 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+//
+// Pointer-based composite (one heap object per node)
+
+namespace pointer {
+
+struct Component
+{
+  virtual ~Component() = default;
+
+  virtual long operation() const = 0;
+  virtual void add(std::unique_ptr<Component> component) { }
+  virtual void remove(Component* component) { }
+};
+
+struct Leaf : public Component
+{
+  Leaf(long v) : value{v} { }
+
+  long operation() const override { return value; }
+
+private:
+  long value;
+};
+
+struct Composite : public Component
+{
+  long operation() const override {
+    long sum = 0;
+    for (const auto& child : children)
+      sum += child->operation();
+    return sum;
+  }
+
+  void add(std::unique_ptr<Component> component) override {
+    children.push_back(std::move(component));
+  }
+
+  void remove(Component* component) override {
+    auto it = std::find_if(children.begin(), children.end(), [&](auto const& child) {
+      return child.get() == component;
+    });
+
+    if (it != children.end())
+      children.erase(it);
+  }
+
+private:
+  std::vector<std::unique_ptr<Component>> children;
+};
+
+} // namespace pointer
+
+//
+// Flattened composite (all nodes stored contiguously)
+
+// Nodes live in a single array and are linked through first-child and
+// next-sibling indices. Clients refer to nodes through stable NodeIds,
+// which survive compaction. Removal only marks a node as a tombstone;
+// compact() later drops dead subtrees and lays out the survivors in
+// preorder so that traversal walks memory front to back.
+class FlatComposite {
+public:
+  using NodeId = std::uint32_t;
+
+  static constexpr NodeId npos = std::numeric_limits<NodeId>::max();
+
+  enum class Kind : std::uint8_t { leaf, composite };
+
+  // The tree always contains a root composite
+  FlatComposite() { push_node(npos, Kind::composite, 0); }
+
+  NodeId root() const { return 0; }
+
+  NodeId add_leaf(NodeId parent, long value) {
+    return add(parent, Kind::leaf, value);
+  }
+
+  NodeId add_composite(NodeId parent) {
+    return add(parent, Kind::composite, 0);
+  }
+
+  // O(1): the node and its subtree are skipped from now on, and the
+  // storage is reclaimed once enough tombstones have accumulated
+  void remove(NodeId id) {
+    index_t i = index_of(id);
+    if (i == npos or i == 0 or not nodes[i].alive)
+      return;
+
+    nodes[i].alive = false;
+    if (++tombstones > nodes.size() / 8)
+      compact();
+  }
+
+  // Returns the index-th live child of parent, or npos
+  NodeId get_child(NodeId parent, std::size_t index) const {
+    index_t i = index_of(parent);
+    if (i == npos or nodes[i].kind != Kind::composite)
+      return npos;
+
+    for (index_t c = nodes[i].first_child; c != npos; c = nodes[c].next_sibling)
+      if (nodes[c].alive and index-- == 0)
+        return ids[c];
+
+    return npos;
+  }
+
+  // Applies op to the value of every live leaf in preorder, using
+  // parent links instead of recursion or an explicit stack
+  template <class Op>
+  void operation(Op&& op) const {
+    index_t i = nodes[0].first_child;
+    while (i != npos) {
+      Node const& n = nodes[i];
+      bool descend = n.alive and n.kind == Kind::composite and n.first_child != npos;
+
+      if (n.alive and n.kind == Kind::leaf)
+        op(values[i]);
+
+      if (descend) {
+        i = n.first_child;
+        continue;
+      }
+      while (i != 0 and nodes[i].next_sibling == npos)
+        i = nodes[i].parent;
+      i = (i == 0) ? npos : nodes[i].next_sibling;
+    }
+  }
+
+  long operation() const {
+    long sum = 0;
+    operation([&](long v) { sum += v; });
+    return sum;
+  }
+
+  // Drops dead subtrees and rewrites the survivors in preorder
+  void compact() {
+    std::vector<Node>   new_nodes;
+    std::vector<long>   new_values;
+    std::vector<NodeId> new_ids;
+    new_nodes.reserve(nodes.size());
+    new_values.reserve(nodes.size());
+    new_ids.reserve(nodes.size());
+
+    std::fill(index.begin(), index.end(), npos);
+
+    // Old indices of the nodes still to be copied, with their new parent
+    std::vector<std::pair<index_t, index_t>> stack{{0, npos}};
+    while (not stack.empty()) {
+      auto [old_i, new_parent] = stack.back();
+      stack.pop_back();
+
+      Node const& n = nodes[old_i];
+      index_t new_i = static_cast<index_t>(new_nodes.size());
+      new_nodes.push_back({new_parent, npos, npos, npos, n.kind, true});
+      new_values.push_back(values[old_i]);
+      new_ids.push_back(ids[old_i]);
+      index[ids[old_i]] = new_i;
+      link(new_nodes, new_parent, new_i);
+
+      // Push children in reverse so that they are copied in order
+      std::size_t mark = stack.size();
+      for (index_t c = n.first_child; c != npos; c = nodes[c].next_sibling)
+        if (nodes[c].alive)
+          stack.emplace_back(c, new_i);
+      std::reverse(stack.begin() + mark, stack.end());
+    }
+
+    nodes      = std::move(new_nodes);
+    values     = std::move(new_values);
+    ids        = std::move(new_ids);
+    tombstones = 0;
+  }
+
+  std::size_t size() const { return nodes.size(); }
+
+private:
+  using index_t = NodeId;
+
+  struct Node {
+    index_t parent;
+    index_t first_child;
+    index_t last_child;
+    index_t next_sibling;
+    Kind    kind;
+    bool    alive;
+  };
+
+  index_t index_of(NodeId id) const {
+    return id < index.size() ? index[id] : npos;
+  }
+
+  NodeId add(NodeId parent, Kind kind, long value) {
+    index_t p = index_of(parent);
+    if (p == npos or nodes[p].kind != Kind::composite)
+      return npos;
+
+    return push_node(p, kind, value);
+  }
+
+  NodeId push_node(index_t parent, Kind kind, long value) {
+    index_t i  = static_cast<index_t>(nodes.size());
+    NodeId  id = static_cast<NodeId>(index.size());
+
+    nodes.push_back({parent, npos, npos, npos, kind, true});
+    values.push_back(value);
+    ids.push_back(id);
+    index.push_back(i);
+    link(nodes, parent, i);
+    return id;
+  }
+
+  // Appends child to the end of parent's child list
+  static void link(std::vector<Node>& ns, index_t parent, index_t child) {
+    if (parent == npos)
+      return;
+
+    if (ns[parent].last_child == npos)
+      ns[parent].first_child = child;
+    else
+      ns[ns[parent].last_child].next_sibling = child;
+    ns[parent].last_child = child;
+  }
+
+  std::vector<Node>    nodes;      // links, indexed by position
+  std::vector<long>    values;     // leaf payloads, indexed by position
+  std::vector<NodeId>  ids;        // position -> NodeId
+  std::vector<index_t> index;      // NodeId -> position (npos once reclaimed)
+  std::size_t          tombstones{0};
+};
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main()
+{
+  // Client usage
+  FlatComposite tree;
+  auto first  = tree.add_leaf(tree.root(), 1);
+  auto group  = tree.add_composite(tree.root());
+  tree.add_leaf(group, 2);
+  tree.add_leaf(group, 3);
+
+  std::cout << "\nFlatComposite::operation" << std::endl;
+  tree.operation([](long v) { std::cout << "Leaf::operation " << v << std::endl; });
+
+  tree.remove(first);
+  std::cout << "\nFlatComposite::operation (after removing the first leaf)" << std::endl;
+  tree.operation([](long v) { std::cout << "Leaf::operation " << v << std::endl; });
+
+  // Benchmark: leaves are added round-robin across the composites, which
+  // scatters siblings in memory for both designs
+  std::size_t const composites = 1'000;
+  std::size_t const leaves     = 1'000;
+  int         const passes     = 10;
+
+  pointer::Composite                 ptree;
+  std::vector<pointer::Composite*>   pgroups;
+  std::vector<pointer::Component*>   pleaves;
+  FlatComposite                      ftree;
+  std::vector<FlatComposite::NodeId> fgroups;
+  std::vector<FlatComposite::NodeId> fleaves;
+
+  double build_p = time_ms([&] {
+    for (std::size_t c = 0; c < composites; ++c) {
+      auto g = std::make_unique<pointer::Composite>();
+      pgroups.push_back(g.get());
+      ptree.add(std::move(g));
+    }
+    for (std::size_t l = 0; l < leaves; ++l)
+      for (std::size_t c = 0; c < composites; ++c) {
+        auto leaf = std::make_unique<pointer::Leaf>(static_cast<long>(l));
+        pleaves.push_back(leaf.get());
+        pgroups[c]->add(std::move(leaf));
+      }
+  });
+
+  double build_f = time_ms([&] {
+    for (std::size_t c = 0; c < composites; ++c)
+      fgroups.push_back(ftree.add_composite(ftree.root()));
+    for (std::size_t l = 0; l < leaves; ++l)
+      for (std::size_t c = 0; c < composites; ++c)
+        fleaves.push_back(ftree.add_leaf(fgroups[c], static_cast<long>(l)));
+  });
+
+  long sum_p{}, sum_f{}, sum_c{};
+  double trav_p = time_ms([&] { for (int i = 0; i < passes; ++i) sum_p += ptree.operation(); });
+  double trav_f = time_ms([&] { for (int i = 0; i < passes; ++i) sum_f += ftree.operation(); });
+  double comp_f = time_ms([&] { ftree.compact(); });
+  double trav_c = time_ms([&] { for (int i = 0; i < passes; ++i) sum_c += ftree.operation(); });
+
+  // Remove 10% of the leaves in random order
+  std::vector<std::size_t> victims(pleaves.size());
+  for (std::size_t i = 0; i < victims.size(); ++i)
+    victims[i] = i;
+  std::shuffle(victims.begin(), victims.end(), std::mt19937{42});
+  victims.resize(victims.size() / 10);
+
+  double rm_p = time_ms([&] {
+    for (auto v : victims)
+      pgroups[v % composites]->remove(pleaves[v]);
+  });
+  double rm_f = time_ms([&] {
+    for (auto v : victims)
+      ftree.remove(fleaves[v]);
+  });
+
+  long after_p = ptree.operation();
+  long after_f = ftree.operation();
+
+  std::size_t const n = composites * leaves;
+  std::cout << "\nBenchmark: " << n << " leaves, " << passes << " traversals"
+            << "\nbuild     pointer: " << build_p << " ms, flat: " << build_f << " ms"
+            << "\ntraverse  pointer: " << trav_p  << " ms, flat: " << trav_f
+            << " ms, flat after compact(): " << trav_c << " ms"
+            << "\ncompact() flat:    " << comp_f  << " ms"
+            << "\nremove " << victims.size() << " leaves  pointer: " << rm_p
+            << " ms, flat: " << rm_f << " ms"
+            << "\nchecksums: " << sum_p << " " << sum_f << " " << sum_c
+            << " | " << after_p << " " << after_f << std::endl;
+}
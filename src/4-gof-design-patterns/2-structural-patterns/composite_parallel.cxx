@@ -0,0 +1,420 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// Work-stealing thread pool
+
+// Each worker owns a deque: it pushes and pops its own tasks at the back
+// (LIFO, which keeps recently forked subtrees hot in cache), while idle
+// workers steal from the front of other deques (FIFO, which takes the
+// oldest and therefore typically largest pieces of work). A thread that
+// waits on a join keeps executing tasks instead of blocking.
+class WorkStealingPool {
+public:
+  explicit WorkStealingPool(unsigned n = std::thread::hardware_concurrency())
+  {
+    n = std::max(n, 1u);
+    for (unsigned i = 0; i < n; ++i)
+      queues.push_back(std::make_unique<Queue>());
+    for (unsigned i = 0; i < n; ++i)
+      threads.emplace_back([this, i] { worker_loop(i); });
+  }
+
+  ~WorkStealingPool()
+  {
+    {
+      std::lock_guard lock{sleep_mutex};
+      stop = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads)
+      t.join();
+  }
+
+  WorkStealingPool(WorkStealingPool const&)            = delete;
+  WorkStealingPool& operator=(WorkStealingPool const&) = delete;
+
+  std::size_t size() const { return threads.size(); }
+
+  // Tasks submitted by a worker go to its own deque, tasks
+  // submitted from outside the pool are spread round-robin
+  void submit(std::function<void()> task)
+  {
+    std::size_t q = (current_pool == this) ? current_index
+                                           : next_queue++ % queues.size();
+    {
+      std::lock_guard lock{queues[q]->mutex};
+      queues[q]->tasks.push_back(std::move(task));
+    }
+    {
+      std::lock_guard lock{sleep_mutex};
+      ++pending;
+    }
+    wake.notify_one();
+  }
+
+  // Runs queued tasks on the calling thread until done() holds
+  template <class Pred>
+  void wait_until(Pred done)
+  {
+    while (not done())
+      if (not run_one())
+        std::this_thread::yield();
+  }
+
+private:
+  struct Queue {
+    std::mutex                        mutex;
+    std::deque<std::function<void()>> tasks;
+  };
+
+  bool pop_local(std::size_t q, std::function<void()>& task)
+  {
+    std::lock_guard lock{queues[q]->mutex};
+    if (queues[q]->tasks.empty())
+      return false;
+    task = std::move(queues[q]->tasks.back());
+    queues[q]->tasks.pop_back();
+    return true;
+  }
+
+  bool steal(std::size_t thief, std::function<void()>& task)
+  {
+    for (std::size_t k = 1; k <= queues.size(); ++k) {
+      auto& victim = *queues[(thief + k) % queues.size()];
+      std::lock_guard lock{victim.mutex};
+      if (not victim.tasks.empty()) {
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool run_one()
+  {
+    std::size_t self = (current_pool == this) ? current_index : 0;
+    std::function<void()> task;
+    if (not ((current_pool == this and pop_local(self, task)) or steal(self, task)))
+      return false;
+
+    {
+      std::lock_guard lock{sleep_mutex};
+      --pending;
+    }
+    task();
+    return true;
+  }
+
+  void worker_loop(std::size_t index)
+  {
+    current_pool  = this;
+    current_index = index;
+
+    for (;;) {
+      if (run_one())
+        continue;
+
+      std::unique_lock lock{sleep_mutex};
+      wake.wait(lock, [this] { return stop or pending > 0; });
+      if (stop)
+        return;
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread>            threads;
+  std::atomic<std::size_t>            next_queue{0};
+
+  std::mutex              sleep_mutex;
+  std::condition_variable wake;
+  std::size_t             pending{0};
+  bool                    stop{false};
+
+  static thread_local WorkStealingPool* current_pool;
+  static thread_local std::size_t       current_index;
+};
+
+thread_local WorkStealingPool* WorkStealingPool::current_pool  = nullptr;
+thread_local std::size_t       WorkStealingPool::current_index = 0;
+
+//
+// Composite
+
+struct Composite;
+
+struct Component
+{
+  virtual ~Component() = default;
+
+  virtual long operation() const = 0;
+  virtual void add(std::unique_ptr<Component> component) { }
+  virtual void remove(Component* component) { }
+  virtual Component* get_child(std::size_t index) const { return nullptr; }
+
+  // Number of children, and number of leaves in the subtree
+  virtual std::size_t child_count() const { return 0; }
+  virtual std::size_t size() const { return 1; }
+
+protected:
+  friend struct Composite;
+  Composite* parent{nullptr};
+};
+
+// The operation of a Leaf is deliberately expensive
+struct Leaf : public Component
+{
+  Leaf(long v) : value{v} { }
+
+  long operation() const override {
+    std::uint64_t x = static_cast<std::uint64_t>(value);
+    for (int i = 0; i < 64; ++i)
+      x = (x * 6364136223846793005ULL + 1442695040888963407ULL) >> 1;
+    return static_cast<long>(x & 0xff);
+  }
+
+private:
+  long value;
+};
+
+template <class T, class LeafOp, class Combine>
+T parallel_reduce(Component const& c, WorkStealingPool& pool, std::size_t grain,
+                  T init, T identity, LeafOp leaf_op, Combine combine);
+
+struct Composite : public Component
+{
+  long operation() const override {
+    long sum = 0;
+    for (const auto& child : children)
+      sum += child->operation();
+    return sum;
+  }
+
+  // Parallel traversal mode; subtrees with at most grain leaves run serially
+  long operation(WorkStealingPool& pool, std::size_t grain) const {
+    return parallel_reduce(*this, pool, grain, 0L, 0L,
+                           [](Component const& leaf) { return leaf.operation(); },
+                           std::plus<long>{});
+  }
+
+  void add(std::unique_ptr<Component> component) override {
+    component->parent = this;
+    grow(static_cast<std::ptrdiff_t>(component->size()));
+    children.push_back(std::move(component));
+  }
+
+  void remove(Component* component) override {
+    auto it = std::find_if(children.begin(), children.end(), [&](auto const& child) {
+      return child.get() == component;
+    });
+
+    if (it != children.end()) {
+      grow(-static_cast<std::ptrdiff_t>((*it)->size()));
+      children.erase(it);
+    }
+  }
+
+  Component* get_child(std::size_t index) const override {
+    if (index < children.size())
+      return children[index].get();
+
+    return nullptr;
+  }
+
+  std::size_t child_count() const override { return children.size(); }
+  std::size_t size() const override { return leaves; }
+
+private:
+  // Keep the leaf counts of all ancestors up to date
+  void grow(std::ptrdiff_t delta) {
+    for (Composite* c = this; c != nullptr; c = c->parent)
+      c->leaves = static_cast<std::size_t>(static_cast<std::ptrdiff_t>(c->leaves) + delta);
+  }
+
+  std::vector<std::unique_ptr<Component>> children;
+  std::size_t leaves{0};
+};
+
+//
+// Parallel reduce
+
+template <class T, class LeafOp, class Combine>
+T serial_reduce(Component const& c, T init, LeafOp& leaf_op, Combine& combine)
+{
+  std::size_t n = c.child_count();
+  if (n == 0 and c.size() == 1)
+    return combine(init, leaf_op(c));
+
+  for (std::size_t i = 0; i < n; ++i)
+    init = serial_reduce(*c.get_child(i), init, leaf_op, combine);
+  return init;
+}
+
+// Folds leaf_op over all leaves of c. The children are split into work
+// units: every child with more than grain leaves is a unit of its own,
+// reduced recursively, and runs of smaller children are grouped into units
+// of roughly grain leaves. Every unit but the last is forked onto the pool
+// and the last one runs on the calling thread. Each unit starts from
+// identity, which must be the identity of combine (0 for plus, 1 for
+// multiplies, ...). Partial results are combined in child order, so a
+// non-commutative combine is still honored.
+template <class T, class LeafOp, class Combine>
+T parallel_reduce(Component const& c, WorkStealingPool& pool, std::size_t grain,
+                  T init, T identity, LeafOp leaf_op, Combine combine)
+{
+  if (c.size() <= grain or c.child_count() == 0)
+    return serial_reduce(c, init, leaf_op, combine);
+
+  // Work units as ranges of children of c
+  struct Unit { std::size_t first, last; };
+  std::vector<Unit> units;
+  std::size_t const n = c.child_count();
+  std::size_t first = 0, weight = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    std::size_t leaves = c.get_child(i)->size();
+    if (leaves > grain) {
+      if (first < i)
+        units.push_back({first, i});
+      units.push_back({i, i + 1});
+      first  = i + 1;
+      weight = 0;
+    }
+    else if ((weight += leaves) >= grain) {
+      units.push_back({first, i + 1});
+      first  = i + 1;
+      weight = 0;
+    }
+  }
+  if (first < n)
+    units.push_back({first, n});
+
+  std::vector<T> partial(units.size(), identity);
+  std::atomic<std::size_t> remaining{units.size() - 1};
+
+  auto run_unit = [&](std::size_t k) {
+    T acc = identity;
+    for (std::size_t i = units[k].first; i < units[k].last; ++i) {
+      Component const& child = *c.get_child(i);
+      acc = (child.size() > grain)
+          ? combine(acc, parallel_reduce(child, pool, grain, identity, identity, leaf_op, combine))
+          : serial_reduce(child, acc, leaf_op, combine);
+    }
+    partial[k] = acc;
+  };
+
+  for (std::size_t k = 0; k + 1 < units.size(); ++k)
+    pool.submit([&, k] {
+      run_unit(k);
+      remaining.fetch_sub(1, std::memory_order_release);
+    });
+
+  run_unit(units.size() - 1);
+  pool.wait_until([&] { return remaining.load(std::memory_order_acquire) == 0; });
+
+  for (auto const& p : partial)
+    init = combine(init, p);
+  return init;
+}
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// width composites of width leaves each
+std::unique_ptr<Composite> balanced_tree(std::size_t width)
+{
+  auto root = std::make_unique<Composite>();
+  for (std::size_t c = 0; c < width; ++c) {
+    auto group = std::make_unique<Composite>();
+    for (std::size_t l = 0; l < width; ++l)
+      group->add(std::make_unique<Leaf>(static_cast<long>(c * width + l)));
+    root->add(std::move(group));
+  }
+  return root;
+}
+
+// A chain of depth composites, each holding width leaves and the next link
+std::unique_ptr<Composite> skewed_tree(std::size_t depth, std::size_t width)
+{
+  auto root = std::make_unique<Composite>();
+  Composite* link = root.get();
+  for (std::size_t d = 0; d < depth; ++d) {
+    for (std::size_t l = 0; l < width; ++l)
+      link->add(std::make_unique<Leaf>(static_cast<long>(d * width + l)));
+    auto next = std::make_unique<Composite>();
+    Composite* raw = next.get();
+    link->add(std::move(next));
+    link = raw;
+  }
+  return root;
+}
+
+void scaling(char const* name, Composite const& tree, std::size_t grain)
+{
+  long expected{};
+  double serial = time_ms([&] { expected = tree.operation(); });
+  std::cout << "\n" << name << " (" << tree.size() << " leaves, grain " << grain << ")"
+            << "\nserial:     " << serial << " ms" << std::endl;
+
+  unsigned hw = std::max(std::thread::hardware_concurrency(), 1u);
+  for (unsigned n = 1; n <= hw; n *= 2) {
+    WorkStealingPool pool{n};
+    long result{};
+    double t = time_ms([&] { result = tree.operation(pool, grain); });
+    std::cout << n << " thread(s): " << t << " ms, speedup " << serial / t
+              << (result == expected ? "" : "  MISMATCH") << std::endl;
+  }
+}
+
+int main()
+{
+  // Client usage
+  std::unique_ptr<Component> composite = std::make_unique<Composite>();
+  composite->add(std::make_unique<Leaf>(1));
+  composite->add(std::make_unique<Leaf>(2));
+
+  WorkStealingPool pool;
+  auto const& c = static_cast<Composite const&>(*composite);
+  std::cout << "Composite::operation (serial):   " << c.operation()        << std::endl;
+  std::cout << "Composite::operation (parallel): " << c.operation(pool, 1) << std::endl;
+
+  // Reductions whose identity is not T{}
+  auto tree = balanced_tree(8);
+  auto leaf = [](Component const& l) { return l.operation(); };
+  auto min  = [](long a, long b) { return std::min(a, b); };
+  auto odd  = [](Component const& l) { return 1.0 + static_cast<double>(l.operation() % 7) / 64; };
+  std::multiplies<double> times;
+  long const max = std::numeric_limits<long>::max();
+  std::cout << "minimum leaf (serial, parallel): " << serial_reduce(*tree, max, leaf, min) << ", "
+            << parallel_reduce(*tree, pool, 4, max, max, leaf, min) << std::endl;
+  std::cout << "product      (serial, parallel): " << serial_reduce(*tree, 1.0, odd, times) << ", "
+            << parallel_reduce(*tree, pool, 4, 1.0, 1.0, odd, times) << std::endl;
+
+  // Benchmark
+  auto balanced = balanced_tree(1'000);
+  auto skewed   = skewed_tree(500, 2'000);
+
+  scaling("balanced", *balanced, 4'096);
+  scaling("skewed",   *skewed,   4'096);
+}
@@ -0,0 +1,194 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// The client-facing interface, shared by both designs
+struct Component
+{
+  virtual ~Component() = default;
+
+  virtual long operation(long x) const = 0;
+};
+
+//
+// Dynamic decorator chain (one allocation and one virtual hop per layer)
+
+namespace dynamic {
+
+struct ConcreteComponent : public Component
+{
+  long operation(long x) const override { return x; }
+};
+
+struct Decorator : public Component
+{
+  Decorator(std::unique_ptr<Component> component)
+  : component(std::move(component)) { }
+
+  long operation(long x) const override {
+    return component->operation(x);
+  }
+
+protected:
+  std::unique_ptr<Component> component;
+};
+
+struct ConcreteDecorator : public Decorator
+{
+  ConcreteDecorator(std::unique_ptr<Component> component)
+  : Decorator(std::move(component)) { }
+
+  long operation(long x) const override {
+    return additional_operation(Decorator::operation(x));
+  }
+
+  long additional_operation(long x) const { return x * 3 + 1; }
+};
+
+} // namespace dynamic
+
+//
+// Static decorator stack (layers are mixins over the object they decorate)
+
+struct ConcreteComponent
+{
+  long operation(long x) const { return x; }
+};
+
+// Each layer inherits from the layer it decorates, so a whole
+// stack is a single object and every call can be inlined
+template <class Inner>
+struct ConcreteDecorator : public Inner
+{
+  using Inner::Inner;
+
+  long operation(long x) const {
+    return additional_operation(Inner::operation(x));
+  }
+
+  long additional_operation(long x) const { return x * 3 + 1; }
+};
+
+template <class Inner>
+struct BoundsDecorator : public Inner
+{
+  using Inner::Inner;
+
+  long operation(long x) const {
+    long r = Inner::operation(x);
+    return r < 0 ? 0 : r;
+  }
+};
+
+// compose_t<C, L1, L2> is L1<L2<C>>, i.e. the first layer is outermost
+template <class C, template <class> class... Layers>
+struct compose { using type = C; };
+
+template <class C, template <class> class Layer, template <class> class... Rest>
+struct compose<C, Layer, Rest...> {
+  using type = Layer<typename compose<C, Rest...>::type>;
+};
+
+template <class C, template <class> class... Layers>
+using compose_t = typename compose<C, Layers...>::type;
+
+// repeat_t<C, L, N> stacks N copies of layer L over C
+template <class C, template <class> class Layer, std::size_t N>
+struct repeat { using type = Layer<typename repeat<C, Layer, N - 1>::type>; };
+
+template <class C, template <class> class Layer>
+struct repeat<C, Layer, 0> { using type = C; };
+
+template <class C, template <class> class Layer, std::size_t N>
+using repeat_t = typename repeat<C, Layer, N>::type;
+
+// The only type-erased boundary: one allocation and one virtual call
+// for the entire stack, however deep it is
+template <class Stack>
+struct StaticDecorator final : public Component, private Stack
+{
+  using Stack::Stack;
+
+  long operation(long x) const override { return Stack::operation(x); }
+};
+
+template <class Stack>
+std::unique_ptr<Component> make_decorated()
+{
+  return std::make_unique<StaticDecorator<Stack>>();
+}
+
+//
+// Benchmark
+
+void client(std::unique_ptr<Component> const& c)
+{
+  std::cout << "operation(1) = " << c->operation(1) << std::endl;
+}
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+std::unique_ptr<Component> dynamic_chain(std::size_t depth)
+{
+  std::unique_ptr<Component> c = std::make_unique<dynamic::ConcreteComponent>();
+  for (std::size_t i = 0; i < depth; ++i)
+    c = std::make_unique<dynamic::ConcreteDecorator>(std::move(c));
+  return c;
+}
+
+long call_loop(Component const& c, std::vector<long> const& input)
+{
+  long acc = 0;
+  for (long x : input)
+    acc += c.operation(x);
+  return acc;
+}
+
+template <std::size_t Depth>
+void compare(std::vector<long> const& input)
+{
+  auto dyn  = dynamic_chain(Depth);
+  auto stat = make_decorated<repeat_t<ConcreteComponent, ConcreteDecorator, Depth>>();
+
+  long r1{}, r2{};
+  double t1 = time_ms([&] { r1 = call_loop(*dyn,  input); });
+  double t2 = time_ms([&] { r2 = call_loop(*stat, input); });
+
+  double n = static_cast<double>(input.size());
+  std::cout << "depth " << Depth
+            << ": dynamic " << t1 * 1e6 / n << " ns/call"
+            << ", static "  << t2 * 1e6 / n << " ns/call"
+            << (r1 == r2 ? "" : "  MISMATCH") << std::endl;
+}
+
+int main()
+{
+  // Client usage
+  std::unique_ptr<Component> decorator1
+    = std::make_unique<dynamic::ConcreteDecorator>(std::make_unique<dynamic::ConcreteComponent>());
+  std::unique_ptr<Component> decorator2
+    = make_decorated<compose_t<ConcreteComponent, BoundsDecorator, ConcreteDecorator>>();
+
+  client(decorator1);
+  client(decorator2);
+
+  // Benchmark
+  std::vector<long> input(20'000'000);
+  for (std::size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<long>(i % 1024);
+
+  std::cout << "\nBenchmark: " << input.size() << " calls per depth" << std::endl;
+  compare<1>(input);
+  compare<4>(input);
+  compare<16>(input);
+}
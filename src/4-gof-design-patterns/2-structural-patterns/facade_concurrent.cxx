@@ -0,0 +1,370 @@
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+// Subsystems take a noticeable amount of time to turn on and off
+struct SubsystemOne
+{
+  void subsys_one_turn_on() {
+    std::this_thread::sleep_for(200ms);
+    std::cout << "Subsystem One On\n";
+  }
+
+  void subsys_one_turn_off() {
+    std::this_thread::sleep_for(50ms);
+    std::cout << "Subsystem One Off\n";
+  }
+};
+
+struct SubsystemTwo
+{
+  void subsys_two_turn_on() {
+    std::this_thread::sleep_for(300ms);
+    std::cout << "Subsystem Two On\n";
+  }
+
+  void subsys_two_turn_off() {
+    std::this_thread::sleep_for(50ms);
+    std::cout << "Subsystem Two Off\n";
+  }
+};
+
+struct SubsystemThree
+{
+  void subsys_three_turn_on() {
+    std::this_thread::sleep_for(250ms);
+    std::cout << "Subsystem Three On\n";
+  }
+
+  void subsys_three_turn_off() {
+    std::this_thread::sleep_for(50ms);
+    std::cout << "Subsystem Three Off\n";
+  }
+};
+
+struct SubsystemFour
+{
+  void subsys_four_turn_on() {
+    std::this_thread::sleep_for(100ms);
+    std::cout << "Subsystem Four On\n";
+  }
+
+  void subsys_four_turn_off() {
+    std::this_thread::sleep_for(50ms);
+    std::cout << "Subsystem Four Off\n";
+  }
+};
+
+//
+// Serial facade
+
+struct Facade
+{
+  void turn_system_on() {
+    ss1.subsys_one_turn_on();
+    ss2.subsys_two_turn_on();
+    ss3.subsys_three_turn_on();
+    ss4.subsys_four_turn_on();
+  }
+
+  void turn_system_off() {
+    ss1.subsys_one_turn_off();
+    ss2.subsys_two_turn_off();
+    ss3.subsys_three_turn_off();
+    ss4.subsys_four_turn_off();
+  }
+
+private:
+  SubsystemOne   ss1;
+  SubsystemTwo   ss2;
+  SubsystemThree ss3;
+  SubsystemFour  ss4;
+};
+
+//
+// Thread pool
+
+class ThreadPool {
+public:
+  explicit ThreadPool(std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      threads.emplace_back([this] { worker_loop(); });
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard lock{mutex};
+      stop = true;
+    }
+    ready.notify_all();
+    for (auto& t : threads)
+      t.join();
+  }
+
+  ThreadPool(ThreadPool const&)            = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  void submit(std::function<void()> task)
+  {
+    {
+      std::lock_guard lock{mutex};
+      tasks.push(std::move(task));
+    }
+    ready.notify_one();
+  }
+
+private:
+  void worker_loop()
+  {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock{mutex};
+        ready.wait(lock, [this] { return stop or not tasks.empty(); });
+        if (stop and tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread>          threads;
+  std::queue<std::function<void()>> tasks;
+  std::mutex                        mutex;
+  std::condition_variable           ready;
+  bool                              stop{false};
+};
+
+//
+// Concurrent facade
+
+// Subsystems are registered with the subsystems they depend on. Turning
+// the system on starts every subsystem as soon as its dependencies are up,
+// so independent subsystems start in parallel; turning it off stops every
+// subsystem once all of its dependents are down (reverse topological
+// order). If a subsystem fails to start, the ones already running are
+// stopped again and the exception is rethrown.
+class ConcurrentFacade {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Timing {
+    std::string               name;
+    std::chrono::milliseconds start;    // offset from the beginning of the phase
+    std::chrono::milliseconds duration;
+  };
+
+  explicit ConcurrentFacade(std::size_t threads = 4)
+  : pool{threads}
+  {
+    auto one   = add_subsystem("SubsystemOne",
+                               [this] { ss1.subsys_one_turn_on(); },
+                               [this] { ss1.subsys_one_turn_off(); });
+    add_subsystem("SubsystemTwo",
+                  [this] { ss2.subsys_two_turn_on(); },
+                  [this] { ss2.subsys_two_turn_off(); });
+    auto three = add_subsystem("SubsystemThree",
+                               [this] { ss3.subsys_three_turn_on(); },
+                               [this] { ss3.subsys_three_turn_off(); });
+    add_subsystem("SubsystemFour",
+                  [this] { ss4.subsys_four_turn_on(); },
+                  [this] { ss4.subsys_four_turn_off(); },
+                  {one, three});
+  }
+
+  void turn_system_on() {
+    std::vector<std::vector<std::size_t>> successors(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+      for (auto d : nodes[i].deps)
+        successors[d].push_back(i);
+
+    std::vector<bool> selected(nodes.size(), true);
+    std::exception_ptr error = run(successors, selected, true, start_timings);
+    if (error) {
+      turn_system_off();
+      std::rethrow_exception(error);
+    }
+  }
+
+  void turn_system_off() {
+    std::vector<std::vector<std::size_t>> successors(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+      for (auto d : nodes[i].deps)
+        successors[i].push_back(d);
+
+    std::vector<bool> selected(nodes.size());
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+      selected[i] = nodes[i].running;
+
+    std::exception_ptr error = run(successors, selected, false, stop_timings);
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  std::vector<Timing> const& startup_report()  const { return start_timings; }
+  std::vector<Timing> const& shutdown_report() const { return stop_timings; }
+
+private:
+  struct Node {
+    std::string              name;
+    std::function<void()>    turn_on;
+    std::function<void()>    turn_off;
+    std::vector<std::size_t> deps;
+    bool                     running{false};
+  };
+
+  std::size_t add_subsystem(std::string name,
+                            std::function<void()> on,
+                            std::function<void()> off,
+                            std::vector<std::size_t> deps = {}) {
+    for (auto d : deps)
+      if (d >= nodes.size())
+        throw std::invalid_argument{"unknown dependency of " + name};
+
+    // Dependencies must already be registered, so the graph is acyclic
+    nodes.push_back({std::move(name), std::move(on), std::move(off), std::move(deps)});
+    return nodes.size() - 1;
+  }
+
+  // Runs the selected nodes on the pool, each one only after all of its
+  // selected predecessors (according to successors) have completed.
+  // Returns the first exception thrown, after all in-flight work is done.
+  std::exception_ptr run(std::vector<std::vector<std::size_t>> const& successors,
+                         std::vector<bool> const& selected,
+                         bool turning_on,
+                         std::vector<Timing>& timings) {
+    std::size_t n = nodes.size();
+    std::vector<std::size_t> waiting_on(n, 0);
+    for (std::size_t i = 0; i < n; ++i)
+      if (selected[i])
+        for (auto s : successors[i])
+          if (selected[s])
+            ++waiting_on[s];
+
+    std::mutex              m;
+    std::condition_variable done;
+    std::exception_ptr      error;
+    std::size_t             in_flight = 0;
+    Clock::time_point       phase_start = Clock::now();
+    timings.assign(n, Timing{});
+
+    std::function<void(std::size_t)> launch = [&](std::size_t i) {
+      ++in_flight;
+      pool.submit([&, i] {
+        auto t0 = Clock::now();
+        std::exception_ptr e;
+        try {
+          turning_on ? nodes[i].turn_on() : nodes[i].turn_off();
+        }
+        catch (...) {
+          e = std::current_exception();
+        }
+        auto t1 = Clock::now();
+
+        std::lock_guard lock{m};
+        timings[i] = {nodes[i].name,
+                      std::chrono::duration_cast<std::chrono::milliseconds>(t0 - phase_start),
+                      std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0)};
+        --in_flight;
+
+        // A failed start leaves the subsystem off; a failed stop still
+        // releases its dependencies so that shutdown runs to completion
+        nodes[i].running = turning_on and not e;
+        if (e and not error)
+          error = e;
+
+        if (not (turning_on and error))
+          for (auto s : successors[i])
+            if (selected[s] and --waiting_on[s] == 0)
+              launch(s);
+
+        if (in_flight == 0)
+          done.notify_all();
+      });
+    };
+
+    {
+      std::lock_guard lock{m};
+      for (std::size_t i = 0; i < n; ++i)
+        if (selected[i] and waiting_on[i] == 0)
+          launch(i);
+    }
+
+    std::unique_lock lock{m};
+    done.wait(lock, [&] { return in_flight == 0; });
+
+    // Drop entries for subsystems that never ran
+    std::erase_if(timings, [](Timing const& t) { return t.name.empty(); });
+    return error;
+  }
+
+  SubsystemOne   ss1;
+  SubsystemTwo   ss2;
+  SubsystemThree ss3;
+  SubsystemFour  ss4;
+
+  std::vector<Node>   nodes;
+  std::vector<Timing> start_timings;
+  std::vector<Timing> stop_timings;
+  ThreadPool          pool;
+};
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void print_report(char const* title, std::vector<ConcurrentFacade::Timing> const& timings)
+{
+  std::cout << title << std::endl;
+  for (auto const& t : timings)
+    std::cout << "  " << std::left << std::setw(16) << t.name
+              << " started at " << std::right << std::setw(4) << t.start.count() << " ms"
+              << ", took "      << std::setw(4) << t.duration.count() << " ms" << std::endl;
+}
+
+int main()
+{
+  Facade serial;
+  auto concurrent = std::make_unique<ConcurrentFacade>();
+
+  std::cout << "Serial facade:" << std::endl;
+  double on_s  = time_ms([&] { serial.turn_system_on();  });
+  double off_s = time_ms([&] { serial.turn_system_off(); });
+
+  std::cout << "\nConcurrent facade:" << std::endl;
+  double on_c  = time_ms([&] { concurrent->turn_system_on();  });
+  double off_c = time_ms([&] { concurrent->turn_system_off(); });
+
+  std::cout << std::endl;
+  print_report("Startup report:",  concurrent->startup_report());
+  print_report("Shutdown report:", concurrent->shutdown_report());
+
+  std::cout << "\nWall-clock startup:  serial " << on_s  << " ms, concurrent " << on_c  << " ms"
+            << "\nWall-clock shutdown: serial " << off_s << " ms, concurrent " << off_c << " ms"
+            << std::endl;
+}
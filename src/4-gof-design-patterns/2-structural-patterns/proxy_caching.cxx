@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct Subject
+{
+  virtual ~Subject() = default;
+
+  virtual long request(long key) = 0;
+};
+
+// Expensive to construct and expensive to query
+struct RealSubject : public Subject
+{
+  RealSubject() {
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+  }
+
+  long request(long key) override {
+    std::uint64_t x = static_cast<std::uint64_t>(key);
+    for (int i = 0; i < 2'000; ++i)
+      x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<long>(x >> 33);
+  }
+};
+
+//
+// Sharded LRU cache
+
+// Keys are spread over independent shards, each guarded by its own mutex,
+// so concurrent callers rarely contend. Every shard is a classic LRU: a
+// recency list plus a hash map from key to list position.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ShardedLruCache {
+public:
+  struct Stats {
+    std::size_t hits{0};
+    std::size_t misses{0};
+    std::size_t evictions{0};
+  };
+
+  explicit ShardedLruCache(std::size_t capacity, std::size_t shard_count = 16)
+  : shards(std::max<std::size_t>(shard_count, 1))
+  {
+    std::size_t per_shard = std::max<std::size_t>(capacity / shards.size(), 1);
+    for (auto& s : shards)
+      s.capacity = per_shard;
+  }
+
+  std::optional<Value> get(Key const& key) {
+    Shard& s = shard_for(key);
+    std::lock_guard lock{s.mutex};
+
+    auto it = s.index.find(key);
+    if (it == s.index.end()) {
+      ++s.stats.misses;
+      return std::nullopt;
+    }
+
+    ++s.stats.hits;
+    s.entries.splice(s.entries.begin(), s.entries, it->second);
+    return it->second->second;
+  }
+
+  void put(Key const& key, Value value) {
+    Shard& s = shard_for(key);
+    std::lock_guard lock{s.mutex};
+
+    if (auto it = s.index.find(key); it != s.index.end()) {
+      it->second->second = std::move(value);
+      s.entries.splice(s.entries.begin(), s.entries, it->second);
+      return;
+    }
+
+    if (s.entries.size() == s.capacity) {
+      s.index.erase(s.entries.back().first);
+      s.entries.pop_back();
+      ++s.stats.evictions;
+    }
+    s.entries.emplace_front(key, std::move(value));
+    s.index.emplace(key, s.entries.begin());
+  }
+
+  Stats stats() const {
+    Stats total;
+    for (auto const& s : shards) {
+      std::lock_guard lock{s.mutex};
+      total.hits      += s.stats.hits;
+      total.misses    += s.stats.misses;
+      total.evictions += s.stats.evictions;
+    }
+    return total;
+  }
+
+private:
+  using Entries = std::list<std::pair<Key, Value>>;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    Entries            entries;   // most recently used first
+    std::unordered_map<Key, typename Entries::iterator, Hash> index;
+    std::size_t        capacity{0};
+    Stats              stats;
+  };
+
+  Shard& shard_for(Key const& key) {
+    // Mix the hash so that shards stay balanced for identity hashes
+    std::uint64_t h = Hash{}(key) * 0x9E3779B97F4A7C15ULL;
+    return shards[(h >> 32) % shards.size()];
+  }
+
+  std::vector<Shard> shards;
+};
+
+//
+// Caching proxy
+
+// The RealSubject is only constructed on the first request, and results
+// are memoized per key. Safe to call from several threads at once.
+struct CachingProxy : public Subject
+{
+  explicit CachingProxy(std::size_t capacity)
+  : cache{capacity} { }
+
+  long request(long key) override {
+    if (auto hit = cache.get(key))
+      return *hit;
+
+    long value = subject().request(key);
+    cache.put(key, value);
+    return value;
+  }
+
+  ShardedLruCache<long, long>::Stats stats() const { return cache.stats(); }
+
+private:
+  RealSubject& subject() {
+    std::call_once(constructed, [this] { real_subject = std::make_unique<RealSubject>(); });
+    return *real_subject;
+  }
+
+  std::once_flag               constructed;
+  std::unique_ptr<RealSubject> real_subject;
+  ShardedLruCache<long, long>  cache;
+};
+
+//
+// Benchmark
+
+// Samples keys in [0, n) where key k has probability proportional to 1/(k+1)^s
+class ZipfDistribution {
+public:
+  ZipfDistribution(std::size_t n, double s)
+  : cdf(n)
+  {
+    double sum = 0;
+    for (std::size_t k = 0; k < n; ++k)
+      cdf[k] = (sum += 1.0 / std::pow(static_cast<double>(k + 1), s));
+    for (auto& c : cdf)
+      c /= sum;
+  }
+
+  template <class Rng>
+  long operator()(Rng& rng) const {
+    double u = std::uniform_real_distribution<double>{0.0, 1.0}(rng);
+    auto it = std::lower_bound(cdf.begin(), cdf.end(), u);
+    return static_cast<long>(std::min<std::size_t>(it - cdf.begin(), cdf.size() - 1));
+  }
+
+private:
+  std::vector<double> cdf;
+};
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Replays each stream of keys on its own caller thread
+double run(Subject& s, std::vector<std::vector<long>> const& streams)
+{
+  return time_ms([&] {
+    std::vector<std::thread> callers;
+    for (auto const& keys : streams)
+      callers.emplace_back([&s, &keys] {
+        long sink = 0;
+        for (long k : keys)
+          sink += s.request(k);
+        volatile long keep = sink;
+        (void)keep;
+      });
+    for (auto& t : callers)
+      t.join();
+  });
+}
+
+void client(std::unique_ptr<Subject> const& s)
+{
+  std::cout << "request(7) = " << s->request(7) << std::endl;
+}
+
+int main()
+{
+  // Client usage
+  std::unique_ptr<Subject> subject = std::make_unique<CachingProxy>(1'024);
+  client(subject);   // constructs the RealSubject, cache miss
+  client(subject);   // cache hit
+
+  // Benchmark
+  std::size_t const keys     = 100'000;
+  std::size_t const capacity = 10'000;
+  std::size_t const threads  = 4;
+  std::size_t const requests = 100'000;   // per thread
+
+  std::cout << "\nBenchmark: " << threads << " threads x " << requests
+            << " requests, " << keys << " keys, cache capacity " << capacity << std::endl;
+
+  for (double skew : {0.8, 0.99, 1.2}) {
+    ZipfDistribution zipf{keys, skew};
+    std::vector<std::vector<long>> streams(threads);
+    for (std::size_t t = 0; t < threads; ++t) {
+      std::mt19937_64 rng{t + 1};
+      for (std::size_t i = 0; i < requests; ++i)
+        streams[t].push_back(zipf(rng));
+    }
+
+    RealSubject direct;
+    CachingProxy proxy{capacity};
+    double t_direct = run(direct, streams);
+    double t_proxy  = run(proxy,  streams);
+
+    auto st = proxy.stats();
+    double total = static_cast<double>(threads * requests);
+    std::cout << "zipf s=" << skew
+              << ": direct " << t_direct * 1e6 / total << " ns/request"
+              << ", caching proxy " << t_proxy * 1e6 / total << " ns/request"
+              << ", hit rate " << 100.0 * static_cast<double>(st.hits) / total << "%"
+              << ", evictions " << st.evictions << std::endl;
+  }
+}
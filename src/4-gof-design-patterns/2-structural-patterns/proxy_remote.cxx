@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+struct Subject
+{
+  virtual ~Subject() = default;
+
+  virtual long request(long key) = 0;
+};
+
+struct RealSubject : public Subject
+{
+  long request(long key) override {
+    std::uint64_t x = static_cast<std::uint64_t>(key);
+    for (int i = 0; i < 100; ++i)
+      x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<long>(x >> 33);
+  }
+};
+
+//
+// Wire format
+
+// A frame is a 32-bit entry count followed by that many entries. Requests
+// carry the argument in value, responses carry the result under the same
+// id. Both ends run the same binary on the same machine, so entries are
+// sent in native layout.
+struct Entry {
+  std::uint64_t id;
+  std::int64_t  value;
+};
+
+// Returns false on a clean end-of-stream before any byte was read
+bool read_all(int fd, void* buf, std::size_t n)
+{
+  auto* p = static_cast<char*>(buf);
+  std::size_t done = 0;
+  while (done < n) {
+    ssize_t r = ::read(fd, p + done, n - done);
+    if (r == 0 and done == 0)
+      return false;
+    if (r == 0)
+      throw std::runtime_error{"truncated frame"};
+    if (r < 0) {
+      if (errno == EINTR)
+        continue;
+      throw std::system_error{errno, std::generic_category(), "read"};
+    }
+    done += static_cast<std::size_t>(r);
+  }
+  return true;
+}
+
+void write_all(int fd, void const* buf, std::size_t n)
+{
+  auto const* p = static_cast<char const*>(buf);
+  while (n > 0) {
+    ssize_t r = ::send(fd, p, n, MSG_NOSIGNAL);
+    if (r < 0) {
+      if (errno == EINTR)
+        continue;
+      throw std::system_error{errno, std::generic_category(), "send"};
+    }
+    p += r;
+    n -= static_cast<std::size_t>(r);
+  }
+}
+
+void write_frame(int fd, std::vector<Entry> const& entries, std::vector<char>& buffer)
+{
+  auto count = static_cast<std::uint32_t>(entries.size());
+  buffer.resize(sizeof(count) + entries.size() * sizeof(Entry));
+  std::memcpy(buffer.data(), &count, sizeof(count));
+  std::memcpy(buffer.data() + sizeof(count), entries.data(), entries.size() * sizeof(Entry));
+  write_all(fd, buffer.data(), buffer.size());
+}
+
+bool read_frame(int fd, std::vector<Entry>& entries)
+{
+  std::uint32_t count;
+  if (not read_all(fd, &count, sizeof(count)))
+    return false;
+  entries.resize(count);
+  read_all(fd, entries.data(), count * sizeof(Entry));
+  return true;
+}
+
+//
+// Local stand-in server
+
+// Forks a child process that owns the RealSubject and answers frames
+// over a Unix domain socket until the client closes its end
+struct ServerProcess {
+  pid_t pid;
+  int   fd;   // client end of the socket
+};
+
+ServerProcess spawn_server()
+{
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0)
+    throw std::system_error{errno, std::generic_category(), "socketpair"};
+
+  pid_t pid = ::fork();
+  if (pid < 0)
+    throw std::system_error{errno, std::generic_category(), "fork"};
+
+  if (pid == 0) {
+    ::close(fds[0]);
+    RealSubject subject;
+    std::vector<Entry> entries;
+    std::vector<char>  buffer;
+    try {
+      while (read_frame(fds[1], entries)) {
+        for (auto& e : entries)
+          e.value = subject.request(e.value);
+        write_frame(fds[1], entries, buffer);
+      }
+    }
+    catch (...) {
+      ::_exit(1);
+    }
+    ::_exit(0);
+  }
+
+  ::close(fds[1]);
+  return {pid, fds[0]};
+}
+
+//
+// Remote proxy
+
+// Callers block in request() while a sender thread coalesces everything
+// queued so far (up to max_batch entries) into one frame, and a receiver
+// thread matches responses to callers by id. The sender never waits for
+// responses, so frames are pipelined. max_batch == 1 disables batching.
+struct RemoteProxy : public Subject
+{
+  explicit RemoteProxy(std::size_t max_batch = 256)
+  : max_batch{std::max<std::size_t>(max_batch, 1)}
+  , server{spawn_server()}
+  {
+    sender   = std::thread{[this] { send_loop(); }};
+    receiver = std::thread{[this] { receive_loop(); }};
+  }
+
+  ~RemoteProxy() override {
+    {
+      std::lock_guard lock{mutex};
+      stop = true;
+    }
+    queued.notify_one();
+    sender.join();
+
+    // The server sees end-of-stream, exits and closes its end,
+    // which in turn ends the receiver
+    ::shutdown(server.fd, SHUT_WR);
+    receiver.join();
+    ::close(server.fd);
+    ::waitpid(server.pid, nullptr, 0);
+  }
+
+  RemoteProxy(RemoteProxy const&)            = delete;
+  RemoteProxy& operator=(RemoteProxy const&) = delete;
+
+  long request(long key) override {
+    std::future<long> result;
+    {
+      std::lock_guard lock{mutex};
+      if (broken)
+        throw std::runtime_error{"remote subject unavailable"};
+      std::uint64_t id = next_id++;
+      result = pending[id].get_future();
+      outgoing.push_back({id, key});
+    }
+    queued.notify_one();
+    return result.get();
+  }
+
+  // Average number of requests per frame sent so far
+  double average_batch() const {
+    std::lock_guard lock{mutex};
+    return frames ? static_cast<double>(requests) / static_cast<double>(frames) : 0.0;
+  }
+
+private:
+  void send_loop() {
+    std::vector<Entry> batch;
+    std::vector<char>  buffer;
+    std::unique_lock lock{mutex};
+    for (;;) {
+      queued.wait(lock, [this] { return stop or not outgoing.empty(); });
+      if (outgoing.empty())
+        return;
+
+      std::size_t n = std::min(outgoing.size(), max_batch);
+      batch.assign(outgoing.begin(), outgoing.begin() + static_cast<std::ptrdiff_t>(n));
+      outgoing.erase(outgoing.begin(), outgoing.begin() + static_cast<std::ptrdiff_t>(n));
+      ++frames;
+      requests += n;
+
+      lock.unlock();
+      try {
+        write_frame(server.fd, batch, buffer);
+      }
+      catch (...) {
+        lock.lock();
+        fail_pending(std::current_exception());
+        return;
+      }
+      lock.lock();
+    }
+  }
+
+  void receive_loop() {
+    std::vector<Entry> entries;
+    std::exception_ptr error;
+    try {
+      while (read_frame(server.fd, entries)) {
+        std::lock_guard lock{mutex};
+        for (auto const& e : entries) {
+          // A response nobody waits for (duplicated, stale or corrupted id)
+          // means the stream can no longer be trusted
+          auto it = pending.find(e.id);
+          if (it == pending.end())
+            throw std::runtime_error{"protocol error: response to unknown request " + std::to_string(e.id)};
+          it->second.set_value(e.value);
+          pending.erase(it);
+        }
+      }
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+
+    std::lock_guard lock{mutex};
+    if (not error)
+      error = std::make_exception_ptr(std::runtime_error{"remote subject closed the connection"});
+    fail_pending(error);
+  }
+
+  // Requires mutex to be held
+  void fail_pending(std::exception_ptr error) {
+    broken = true;
+    for (auto& [id, p] : pending)
+      p.set_exception(error);
+    pending.clear();
+    outgoing.clear();
+  }
+
+  std::size_t   max_batch;
+  ServerProcess server;
+
+  mutable std::mutex      mutex;
+  std::condition_variable queued;
+  std::deque<Entry>       outgoing;
+  std::unordered_map<std::uint64_t, std::promise<long>> pending;
+  std::uint64_t           next_id{0};
+  std::size_t             frames{0};
+  std::size_t             requests{0};
+  bool                    stop{false};
+  bool                    broken{false};
+
+  std::thread sender;
+  std::thread receiver;
+};
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void client(std::unique_ptr<Subject> const& s)
+{
+  std::cout << "request(7) = " << s->request(7) << std::endl;
+}
+
+void benchmark(char const* name, std::size_t max_batch)
+{
+  std::size_t const sequential = 20'000;
+  std::size_t const callers    = 16;
+  std::size_t const per_caller = 10'000;
+
+  RemoteProxy proxy{max_batch};
+
+  double latency = time_ms([&] {
+    for (std::size_t i = 0; i < sequential; ++i)
+      proxy.request(static_cast<long>(i));
+  });
+
+  double throughput = time_ms([&] {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < callers; ++t)
+      threads.emplace_back([&, t] {
+        for (std::size_t i = 0; i < per_caller; ++i)
+          proxy.request(static_cast<long>(t * per_caller + i));
+      });
+    for (auto& th : threads)
+      th.join();
+  });
+
+  double total = static_cast<double>(callers * per_caller);
+  std::cout << name
+            << ": round trip " << latency * 1e3 / static_cast<double>(sequential) << " us"
+            << ", throughput (" << callers << " callers) " << total / throughput * 1e3 << " req/s"
+            << ", average batch " << proxy.average_batch() << std::endl;
+}
+
+int main()
+{
+  // Client usage
+  {
+    std::unique_ptr<Subject> subject = std::make_unique<RemoteProxy>();
+    client(subject);
+    RealSubject local;
+    std::cout << "local request(7) = " << local.request(7) << std::endl;
+  }
+
+  // Benchmark
+  std::cout << "\nBenchmark:" << std::endl;
+  benchmark("without batching", 1);
+  benchmark("with batching   ", 256);
+}
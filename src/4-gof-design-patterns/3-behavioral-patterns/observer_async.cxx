@@ -0,0 +1,411 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Observer interface
+struct Observer
+{
+  virtual ~Observer() {}
+
+  virtual void update(int value) = 0;
+};
+
+// ConcreteObserver class; delay simulates an expensive update
+struct ConcreteObserver : public Observer
+{
+  explicit ConcreteObserver(std::chrono::microseconds delay = {})
+  : delay{delay} { }
+
+  void update(int value) override {
+    if (delay.count() > 0)
+      std::this_thread::sleep_for(delay);
+    observer_state.store(value, std::memory_order_relaxed);
+  }
+
+  int state() const { return observer_state.load(std::memory_order_relaxed); }
+
+private:
+  std::chrono::microseconds delay;
+  std::atomic<int>          observer_state{0};
+};
+
+// Subject interface
+struct Subject
+{
+  virtual ~Subject() {}
+
+  virtual void attach(std::shared_ptr<Observer> observer) = 0;
+  virtual void detach(std::shared_ptr<Observer> observer) = 0;
+  virtual void notify() = 0;
+};
+
+//
+// Synchronous subject (every update runs on the setter's thread)
+
+struct ConcreteSubject : public Subject
+{
+  void attach(std::shared_ptr<Observer> observer) override {
+    observers.push_back(observer);
+  }
+
+  void detach(std::shared_ptr<Observer> observer) override {
+    auto it = std::find(observers.begin(), observers.end(), observer);
+    if (it != observers.end())
+      observers.erase(it);
+  }
+
+  void notify() override {
+    for (const auto& observer : observers)
+      observer->update(subject_state);
+  }
+
+  void set_state(int value) {
+    subject_state = value;
+    notify();
+  }
+
+private:
+  std::vector<std::shared_ptr<Observer>> observers;
+  int subject_state{0};
+};
+
+//
+// Asynchronous subject
+
+// What happens when an observer's queue is full
+enum class Backpressure {
+  coalesce,   // overwrite the newest queued state, so the latest one is delivered
+  drop,       // discard the incoming state
+  block       // make the producer wait for space
+};
+
+struct ObserverStats {
+  std::size_t               delivered{0};
+  std::size_t               coalesced{0};
+  std::size_t               dropped{0};
+  std::size_t               queued{0};    // current lag in updates
+  std::chrono::microseconds max_lag{0};   // longest wait from notify to update
+};
+
+// Every observer gets a bounded mailbox. notify() only posts the state to
+// each mailbox; a small worker pool drains the mailboxes, running at most
+// one update per observer at a time, so observers see states in order and
+// a slow observer only ever ties up one worker.
+class AsyncSubject : public Subject {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit AsyncSubject(std::size_t workers = 2)
+  {
+    for (std::size_t i = 0; i < workers; ++i)
+      threads.emplace_back([this] { worker_loop(); });
+  }
+
+  // Pending updates are delivered before the workers exit
+  ~AsyncSubject() override {
+    {
+      std::lock_guard lock{ready_mutex};
+      stop = true;
+    }
+    ready_cv.notify_all();
+    for (auto& t : threads)
+      t.join();
+  }
+
+  AsyncSubject(AsyncSubject const&)            = delete;
+  AsyncSubject& operator=(AsyncSubject const&) = delete;
+
+  // By default an observer that falls behind only sees the latest state
+  void attach(std::shared_ptr<Observer> observer) override {
+    attach(std::move(observer), 1, Backpressure::coalesce);
+  }
+
+  void attach(std::shared_ptr<Observer> observer, std::size_t capacity, Backpressure policy) {
+    auto box = std::make_shared<Mailbox>();
+    box->observer = std::move(observer);
+    box->capacity = std::max<std::size_t>(capacity, 1);
+    box->policy   = policy;
+
+    std::lock_guard lock{mailboxes_mutex};
+    mailboxes.push_back(std::move(box));
+  }
+
+  // Updates still queued for the observer are discarded
+  void detach(std::shared_ptr<Observer> observer) override {
+    std::lock_guard lock{mailboxes_mutex};
+    auto it = std::find_if(mailboxes.begin(), mailboxes.end(), [&](auto const& box) {
+      return box->observer == observer;
+    });
+    if (it == mailboxes.end())
+      return;
+
+    {
+      std::lock_guard box_lock{(*it)->mutex};
+      (*it)->closed = true;
+      (*it)->queue.clear();
+    }
+    (*it)->space.notify_all();
+    mailboxes.erase(it);
+  }
+
+  void notify() override {
+    std::vector<std::shared_ptr<Mailbox>> targets;
+    {
+      std::lock_guard lock{mailboxes_mutex};
+      targets = mailboxes;
+    }
+
+    int state = subject_state.load(std::memory_order_relaxed);
+    for (auto& box : targets)
+      post(box, state);
+  }
+
+  void set_state(int value) {
+    subject_state.store(value, std::memory_order_relaxed);
+    notify();
+  }
+
+  // Per-observer metrics, in attach order
+  std::vector<ObserverStats> stats() const {
+    std::lock_guard lock{mailboxes_mutex};
+    std::vector<ObserverStats> result;
+    for (auto const& box : mailboxes) {
+      std::lock_guard box_lock{box->mutex};
+      result.push_back(box->stats);
+      result.back().queued = box->queue.size();
+    }
+    return result;
+  }
+
+  // Waits until every queued update has been delivered
+  void flush() const {
+    for (;;) {
+      bool idle = true;
+      {
+        std::lock_guard lock{mailboxes_mutex};
+        for (auto const& box : mailboxes) {
+          std::lock_guard box_lock{box->mutex};
+          idle = idle and box->queue.empty() and not box->scheduled;
+        }
+      }
+      if (idle)
+        return;
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+  }
+
+private:
+  struct Pending {
+    int               value;
+    Clock::time_point posted;
+  };
+
+  struct Mailbox {
+    std::shared_ptr<Observer> observer;
+    std::size_t               capacity{1};
+    Backpressure              policy{Backpressure::coalesce};
+
+    mutable std::mutex      mutex;
+    std::condition_variable space;
+    std::deque<Pending>     queue;
+    bool                    scheduled{false};   // queued on, or held by, a worker
+    bool                    closed{false};
+    ObserverStats           stats;
+  };
+
+  // Maximum updates delivered per turn before a mailbox yields its worker
+  static constexpr std::size_t batch = 16;
+
+  void post(std::shared_ptr<Mailbox> const& box, int value) {
+    std::unique_lock lock{box->mutex};
+    if (box->closed)
+      return;
+
+    if (box->queue.size() >= box->capacity) {
+      switch (box->policy) {
+      case Backpressure::coalesce:
+        // Keep the original post time: lag measures how stale the observer is
+        box->queue.back().value = value;
+        ++box->stats.coalesced;
+        return;
+      case Backpressure::drop:
+        ++box->stats.dropped;
+        return;
+      case Backpressure::block:
+        box->space.wait(lock, [&] { return box->closed or box->queue.size() < box->capacity; });
+        if (box->closed)
+          return;
+        break;
+      }
+    }
+
+    box->queue.push_back({value, Clock::now()});
+    if (box->scheduled)
+      return;
+    box->scheduled = true;
+    lock.unlock();
+    schedule(box);
+  }
+
+  void schedule(std::shared_ptr<Mailbox> box) {
+    {
+      std::lock_guard lock{ready_mutex};
+      ready.push_back(std::move(box));
+    }
+    ready_cv.notify_one();
+  }
+
+  void drain(std::shared_ptr<Mailbox> box) {
+    for (std::size_t n = 0; ; ++n) {
+      std::unique_lock lock{box->mutex};
+      if (box->queue.empty()) {
+        box->scheduled = false;
+        return;
+      }
+      if (n == batch) {
+        lock.unlock();
+        schedule(std::move(box));
+        return;
+      }
+
+      Pending p = box->queue.front();
+      box->queue.pop_front();
+      lock.unlock();
+      box->space.notify_one();
+
+      box->observer->update(p.value);
+
+      auto lag = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - p.posted);
+      lock.lock();
+      ++box->stats.delivered;
+      box->stats.max_lag = std::max(box->stats.max_lag, lag);
+    }
+  }
+
+  void worker_loop() {
+    for (;;) {
+      std::shared_ptr<Mailbox> box;
+      {
+        std::unique_lock lock{ready_mutex};
+        ready_cv.wait(lock, [this] { return stop or not ready.empty(); });
+        if (ready.empty())
+          return;
+        box = std::move(ready.front());
+        ready.pop_front();
+      }
+      drain(std::move(box));
+    }
+  }
+
+  mutable std::mutex                    mailboxes_mutex;
+  std::vector<std::shared_ptr<Mailbox>> mailboxes;
+  std::atomic<int>                      subject_state{0};
+
+  std::mutex                           ready_mutex;
+  std::condition_variable              ready_cv;
+  std::deque<std::shared_ptr<Mailbox>> ready;
+  bool                                 stop{false};
+  std::vector<std::thread>             threads;
+};
+
+//
+// Benchmark
+
+struct Latency {
+  double average_us;
+  double max_us;
+};
+
+// Calls set_state n times and records how long each call blocks the producer
+template <class S>
+Latency producer_latency(S& subject, int n)
+{
+  using Clock = std::chrono::steady_clock;
+  double total = 0, worst = 0;
+  for (int i = 1; i <= n; ++i) {
+    auto t0 = Clock::now();
+    subject.set_state(i);
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+    total += us;
+    worst  = std::max(worst, us);
+    // Produce at a steady rate faster than the slow observer can consume
+    std::this_thread::sleep_for(std::chrono::microseconds{20});
+  }
+  return {total / n, worst};
+}
+
+void print_stats(std::vector<ObserverStats> const& stats)
+{
+  for (std::size_t i = 0; i < stats.size(); ++i)
+    std::cout << "  observer " << i
+              << ": delivered " << stats[i].delivered
+              << ", coalesced " << stats[i].coalesced
+              << ", dropped "   << stats[i].dropped
+              << ", queued "    << stats[i].queued
+              << ", max lag "   << stats[i].max_lag.count() << " us" << std::endl;
+}
+
+int main()
+{
+  using namespace std::chrono_literals;
+
+  // Client usage
+  {
+    AsyncSubject subject;
+    auto observer1 = std::make_shared<ConcreteObserver>();
+    auto observer2 = std::make_shared<ConcreteObserver>();
+    subject.attach(observer1);
+    subject.attach(observer2, 8, Backpressure::block);
+
+    subject.set_state(42);
+    subject.set_state(100);
+    subject.flush();
+    std::cout << "observer1 state: " << observer1->state()
+              << ", observer2 state: " << observer2->state() << std::endl;
+  }
+
+  // Benchmark: three fast observers and one slow one
+  int const n = 2'000;
+  auto slow = 500us;
+
+  std::cout << "\nBenchmark: producer latency over " << n << " set_state calls"
+            << " with one observer taking " << slow.count() << " us per update" << std::endl;
+
+  {
+    ConcreteSubject subject;
+    for (int i = 0; i < 3; ++i)
+      subject.attach(std::make_shared<ConcreteObserver>());
+    subject.attach(std::make_shared<ConcreteObserver>(slow));
+
+    auto l = producer_latency(subject, n);
+    std::cout << "synchronous: average " << l.average_us << " us, max " << l.max_us << " us" << std::endl;
+  }
+
+  struct Config {
+    char const*  name;
+    std::size_t  capacity;
+    Backpressure policy;
+  };
+
+  for (auto const& c : {Config{"async coalesce (capacity 1)", 1,  Backpressure::coalesce},
+                        Config{"async drop (capacity 64)",    64, Backpressure::drop},
+                        Config{"async block (capacity 64)",   64, Backpressure::block}}) {
+    AsyncSubject subject;
+    for (int i = 0; i < 3; ++i)
+      subject.attach(std::make_shared<ConcreteObserver>(), c.capacity, c.policy);
+    subject.attach(std::make_shared<ConcreteObserver>(slow), c.capacity, c.policy);
+
+    auto l = producer_latency(subject, n);
+    std::cout << c.name << ": average " << l.average_us << " us, max " << l.max_us << " us" << std::endl;
+    print_stats(subject.stats());
+  }
+}
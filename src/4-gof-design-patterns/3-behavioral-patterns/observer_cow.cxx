@@ -0,0 +1,293 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Observer interface
+struct Observer
+{
+  virtual ~Observer() {}
+
+  virtual void update(int value) = 0;
+};
+
+// ConcreteObserver may be updated from several threads at once
+struct ConcreteObserver : public Observer
+{
+  void update(int value) override {
+    observer_state.store(value, std::memory_order_relaxed);
+    updates.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  long update_count() const { return updates.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<int>  observer_state{0};
+  std::atomic<long> updates{0};
+};
+
+// Subject interface
+struct Subject
+{
+  virtual ~Subject() {}
+
+  virtual void attach(std::shared_ptr<Observer> observer) = 0;
+  virtual void detach(std::shared_ptr<Observer> observer) = 0;
+  virtual void notify() = 0;
+};
+
+//
+// Epoch-based reclamation
+
+// Readers announce the global epoch they started in; writers retire old
+// data tagged with the epoch in which it was unpublished, and free it once
+// every active reader has moved past that epoch. Entering and leaving a
+// read section is a pair of atomic stores on a thread-private cache line.
+namespace epoch {
+
+inline constexpr std::size_t max_threads = 256;
+
+struct alignas(64) Slot {
+  std::atomic<std::uint64_t> epoch{0};   // 0 while outside a read section
+  std::atomic<bool>          used{false};
+};
+
+inline Slot                       slots[max_threads];
+inline std::atomic<std::uint64_t> global_epoch{1};
+
+// Each thread claims a slot on first use and releases it when it exits
+struct ThreadSlot {
+  ThreadSlot() {
+    for (auto& s : slots) {
+      bool expected = false;
+      if (s.used.compare_exchange_strong(expected, true)) {
+        slot = &s;
+        return;
+      }
+    }
+    throw std::runtime_error{"epoch: too many reader threads"};
+  }
+
+  ~ThreadSlot() { slot->used.store(false, std::memory_order_release); }
+
+  Slot* slot{nullptr};
+  int   depth{0};
+};
+
+inline thread_local ThreadSlot this_thread;
+
+// RAII read section; nested sections (e.g. an observer that notifies
+// another subject) only publish the outermost epoch
+class ReadGuard {
+public:
+  ReadGuard() {
+    if (this_thread.depth++ == 0)
+      this_thread.slot->epoch.store(global_epoch.load());
+  }
+
+  ~ReadGuard() {
+    if (--this_thread.depth == 0)
+      this_thread.slot->epoch.store(0, std::memory_order_release);
+  }
+
+  ReadGuard(ReadGuard const&)            = delete;
+  ReadGuard& operator=(ReadGuard const&) = delete;
+};
+
+// The oldest epoch any reader may still be working in
+inline std::uint64_t oldest_active()
+{
+  std::uint64_t oldest = std::numeric_limits<std::uint64_t>::max();
+  for (auto const& s : slots)
+    if (std::uint64_t e = s.epoch.load(); e != 0)
+      oldest = std::min(oldest, e);
+  return oldest;
+}
+
+} // namespace epoch
+
+//
+// Copy-on-write subject
+
+// notify() iterates an immutable snapshot of the observer list without
+// taking a lock or touching reference counts. attach() and detach() are
+// serialized among themselves, copy the list, publish the copy and retire
+// the previous one. A notification that is already running may still
+// reach an observer that was detached concurrently.
+struct CowSubject : public Subject
+{
+  CowSubject() : observers{new List{}} { }
+
+  ~CowSubject() override {
+    delete observers.load();
+  }
+
+  void attach(std::shared_ptr<Observer> observer) override {
+    std::lock_guard lock{write_mutex};
+    auto next = std::make_unique<List>(*observers.load());
+    next->push_back(std::move(observer));
+    publish(std::move(next));
+  }
+
+  void detach(std::shared_ptr<Observer> observer) override {
+    std::lock_guard lock{write_mutex};
+    List const& current = *observers.load();
+    auto it = std::find(current.begin(), current.end(), observer);
+    if (it == current.end())
+      return;
+
+    auto next = std::make_unique<List>();
+    next->reserve(current.size() - 1);
+    next->insert(next->end(), current.begin(), it);
+    next->insert(next->end(), it + 1, current.end());
+    publish(std::move(next));
+  }
+
+  void notify() override {
+    epoch::ReadGuard guard;
+    int state = subject_state.load(std::memory_order_relaxed);
+    for (const auto& observer : *observers.load())
+      observer->update(state);
+  }
+
+  void set_state(int value) {
+    subject_state.store(value, std::memory_order_relaxed);
+    notify();
+  }
+
+private:
+  using List = std::vector<std::shared_ptr<Observer>>;
+
+  struct Retired {
+    std::unique_ptr<List const> list;
+    std::uint64_t               epoch;
+  };
+
+  // Requires write_mutex to be held
+  void publish(std::unique_ptr<List> next) {
+    List const* old = observers.exchange(next.release());
+    retired.push_back({std::unique_ptr<List const>{old}, epoch::global_epoch.fetch_add(1)});
+
+    std::uint64_t oldest = epoch::oldest_active();
+    std::erase_if(retired, [&](Retired const& r) { return r.epoch < oldest; });
+  }
+
+  std::atomic<List const*> observers;
+  std::atomic<int>         subject_state{0};
+  std::mutex               write_mutex;
+  std::vector<Retired>     retired;
+};
+
+//
+// Mutex-guarded subject (baseline)
+
+struct LockedSubject : public Subject
+{
+  void attach(std::shared_ptr<Observer> observer) override {
+    std::lock_guard lock{mutex};
+    observers.push_back(std::move(observer));
+  }
+
+  void detach(std::shared_ptr<Observer> observer) override {
+    std::lock_guard lock{mutex};
+    auto it = std::find(observers.begin(), observers.end(), observer);
+    if (it != observers.end())
+      observers.erase(it);
+  }
+
+  void notify() override {
+    std::lock_guard lock{mutex};
+    int state = subject_state.load(std::memory_order_relaxed);
+    for (const auto& observer : observers)
+      observer->update(state);
+  }
+
+  void set_state(int value) {
+    subject_state.store(value, std::memory_order_relaxed);
+    notify();
+  }
+
+private:
+  std::vector<std::shared_ptr<Observer>> observers;
+  std::atomic<int>                       subject_state{0};
+  std::mutex                             mutex;
+};
+
+//
+// Benchmark
+
+// notifiers threads call set_state in a loop while one thread keeps
+// attaching and detaching an observer; returns notifications per second
+template <class S>
+double churn(unsigned notifiers, std::chrono::milliseconds duration)
+{
+  S subject;
+  std::vector<std::shared_ptr<ConcreteObserver>> stable;
+  for (int i = 0; i < 16; ++i) {
+    stable.push_back(std::make_shared<ConcreteObserver>());
+    subject.attach(stable.back());
+  }
+
+  std::atomic<bool> running{true};
+  std::atomic<long> notifications{0};
+
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < notifiers; ++t)
+    threads.emplace_back([&] {
+      long n = 0;
+      while (running.load(std::memory_order_relaxed))
+        subject.set_state(static_cast<int>(++n));
+      notifications.fetch_add(n);
+    });
+
+  threads.emplace_back([&] {
+    auto transient = std::make_shared<ConcreteObserver>();
+    while (running.load(std::memory_order_relaxed)) {
+      subject.attach(transient);
+      subject.detach(transient);
+    }
+  });
+
+  std::this_thread::sleep_for(duration);
+  running = false;
+  for (auto& t : threads)
+    t.join();
+
+  return static_cast<double>(notifications.load())
+       / std::chrono::duration<double>(duration).count();
+}
+
+int main()
+{
+  // Client usage
+  auto subject   = std::make_unique<CowSubject>();
+  auto observer1 = std::make_shared<ConcreteObserver>();
+  auto observer2 = std::make_shared<ConcreteObserver>();
+
+  subject->attach(observer1);
+  subject->attach(observer2);
+  subject->set_state(42);
+
+  subject->detach(observer2);
+  subject->set_state(100);
+
+  std::cout << "observer1 updates: " << observer1->update_count()
+            << ", observer2 updates: " << observer2->update_count() << std::endl;
+
+  // Benchmark
+  using namespace std::chrono_literals;
+  std::cout << "\nBenchmark: notify throughput under attach/detach churn" << std::endl;
+  for (unsigned n : {1u, 2u, 4u}) {
+    double locked = churn<LockedSubject>(n, 500ms);
+    double cow    = churn<CowSubject>(n, 500ms);
+    std::cout << n << " notifier(s): mutex " << locked << " notify/s"
+              << ", copy-on-write " << cow << " notify/s" << std::endl;
+  }
+}
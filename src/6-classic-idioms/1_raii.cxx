@@ -1,7 +1,664 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-int main()
+#if defined(__x86_64__) or defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//
+// Scoped trace spans
+
+// A Span acquires a start timestamp in its constructor and releases the
+// finished event in its destructor, so every scope that declares one is
+// traced on all exit paths, exceptions included. Events go to a per-thread
+// single-producer ring buffer (no locks, no allocation); a background
+// Flusher drains the rings and writes Chrome trace-event JSON, which can be
+// opened in chrome://tracing or https://ui.perfetto.dev.
+namespace trace {
+
+// Raw timestamp: the TSC on x86 (assumed invariant), nanoseconds elsewhere
+inline std::uint64_t now() noexcept
 {
-  
-}
\ No newline at end of file
+#if defined(__x86_64__) or defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<std::uint64_t>(
+    std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Timestamps in the output are relative to program start
+std::uint64_t const origin = now();
+
+// Timestamp ticks per microsecond, measured once against steady_clock
+double ticks_per_us()
+{
+  static double const ticks = [] {
+#if defined(__x86_64__) or defined(__i386__)
+    auto t0 = std::chrono::steady_clock::now();
+    auto c0 = now();
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    auto c1 = now();
+    auto t1 = std::chrono::steady_clock::now();
+    return static_cast<double>(c1 - c0) / std::chrono::duration<double, std::micro>(t1 - t0).count();
+#else
+    return 1e3;
+#endif
+  }();
+  return ticks;
+}
+
+std::atomic<bool> enabled{true};
+
+struct Event {
+  char const*   name;    // must have static storage duration
+  std::uint64_t begin;
+  std::uint64_t end;
+};
+
+// Fixed-capacity ring with one writer (the owning thread) and one reader
+// (whoever holds the registry lock). A full ring drops new events rather
+// than blocking the traced code.
+class Ring {
+public:
+  static constexpr std::size_t capacity = std::size_t{1} << 16;
+
+  explicit Ring(std::uint32_t tid) : tid{tid}, events{new Event[capacity]} { }
+
+  void push(Event const& e) noexcept {
+    auto h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == capacity) {
+      dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return;
+    }
+    events[h & (capacity - 1)] = e;
+    head.store(h + 1, std::memory_order_release);
+  }
+
+  template <class F>
+  std::size_t drain(F&& f) {
+    auto t = tail.load(std::memory_order_relaxed);
+    auto h = head.load(std::memory_order_acquire);
+    for (auto i = t; i != h; ++i)
+      f(events[i & (capacity - 1)], tid);
+    tail.store(h, std::memory_order_release);
+    return h - t;
+  }
+
+  std::size_t dropped_count() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+  std::uint32_t const          tid;
+  std::unique_ptr<Event[]>     events;
+  std::atomic<std::uint64_t>   head{0};
+  std::atomic<std::uint64_t>   tail{0};
+  std::atomic<std::size_t>     dropped{0};
+};
+
+// Rings outlive their threads so that events recorded just before a thread
+// exits are still flushed
+struct Registry {
+  std::mutex                         mutex;
+  std::vector<std::shared_ptr<Ring>> rings;
+};
+
+Registry& registry()
+{
+  static Registry r;
+  return r;
+}
+
+Ring& local_ring()
+{
+  thread_local Ring& ring = [] () -> Ring& {
+    auto& r = registry();
+    std::lock_guard lock{r.mutex};
+    r.rings.push_back(std::make_shared<Ring>(static_cast<std::uint32_t>(r.rings.size() + 1)));
+    return *r.rings.back();
+  }();
+  return ring;
+}
+
+// Hands every recorded event to f(event, tid); returns the number of events
+template <class F>
+std::size_t drain(F&& f)
+{
+  auto& r = registry();
+  std::lock_guard lock{r.mutex};
+  std::size_t n = 0;
+  for (auto& ring : r.rings)
+    n += ring->drain(f);
+  return n;
+}
+
+std::size_t dropped()
+{
+  auto& r = registry();
+  std::lock_guard lock{r.mutex};
+  std::size_t n = 0;
+  for (auto& ring : r.rings)
+    n += ring->dropped_count();
+  return n;
+}
+
+class Span {
+public:
+  // name must outlive the trace, e.g. a string literal
+  explicit Span(char const* name) noexcept {
+    if (enabled.load(std::memory_order_relaxed)) {
+      span_name = name;
+      begin     = now();
+    }
+  }
+
+  // The end is read first, so that registering the thread's ring on its
+  // first span is not counted in that span
+  ~Span() {
+    if (span_name) {
+      std::uint64_t const end = now();
+      local_ring().push({span_name, begin, end});
+    }
+  }
+
+  Span(Span const&)            = delete;
+  Span& operator=(Span const&) = delete;
+
+private:
+  char const*   span_name{nullptr};
+  std::uint64_t begin{0};
+};
+
+// Owns the output file and the thread that drains the rings into it every
+// period. The destructor stops the thread, writes the remaining events and
+// closes the JSON array.
+class Flusher {
+public:
+  explicit Flusher(std::string const& path,
+                   std::chrono::milliseconds period = std::chrono::milliseconds{10})
+  : out{path}, period{period}
+  {
+    if (not out)
+      throw std::runtime_error{"cannot open trace file " + path};
+    ticks_per_us();   // calibrate before any event is converted
+    out << "[\n";
+    worker = std::thread{[this] { run(); }};
+  }
+
+  ~Flusher() {
+    {
+      std::lock_guard lock{mutex};
+      stop = true;
+    }
+    wake.notify_one();
+    worker.join();
+    flush();
+    out << "\n]\n";
+  }
+
+  Flusher(Flusher const&)            = delete;
+  Flusher& operator=(Flusher const&) = delete;
+
+private:
+  void run() {
+    std::unique_lock lock{mutex};
+    while (not stop) {
+      wake.wait_for(lock, period, [this] { return stop; });
+      lock.unlock();
+      flush();
+      lock.lock();
+    }
+  }
+
+  void flush() {
+    double const scale = ticks_per_us();
+    drain([&](Event const& e, std::uint32_t tid) {
+      out << (count++ ? ",\n" : "") << R"({"name":")";
+      write_escaped(e.name);
+      out << R"(","ph":"X","pid":1,"tid":)" << tid
+          << R"(,"ts":)"  << static_cast<double>(e.begin - origin) / scale
+          << R"(,"dur":)" << static_cast<double>(e.end - e.begin) / scale << '}';
+    });
+    out.flush();
+  }
+
+  // Writes name as the contents of a JSON string
+  void write_escaped(char const* name) {
+    for (; *name; ++name) {
+      auto c = static_cast<unsigned char>(*name);
+      if (c == '"' or c == '\\')
+        out << '\\' << *name;
+      else if (c < 0x20)
+        out << "\\u00" << "0123456789abcdef"[c >> 4] << "0123456789abcdef"[c & 0xf];
+      else
+        out << *name;
+    }
+  }
+
+  std::ofstream             out;
+  std::chrono::milliseconds period;
+  std::size_t               count{0};   // events written so far
+  std::mutex                mutex;
+  std::condition_variable   wake;
+  bool                      stop{false};
+  std::thread               worker;
+};
+
+} // namespace trace
+
+//
+// Memory-mapped file
+
+// Owns a POSIX file descriptor; closes it on destruction
+class FileDescriptor {
+public:
+  explicit FileDescriptor(int fd = -1) noexcept : fd{fd} { }
+
+  ~FileDescriptor() {
+    if (fd >= 0)
+      ::close(fd);
+  }
+
+  FileDescriptor(FileDescriptor&& other) noexcept : fd{std::exchange(other.fd, -1)} { }
+
+  // The previous descriptor is closed when other is destroyed
+  FileDescriptor& operator=(FileDescriptor&& other) noexcept {
+    std::swap(fd, other.fd);
+    return *this;
+  }
+
+  int get() const { return fd; }
+
+private:
+  int fd;
+};
+
+enum class Access {
+  normal,
+  sequential,   // aggressive read-ahead; pages behind the reader can be dropped early
+  random        // no read-ahead
+};
+
+// Maps a whole file read-only. The constructor opens, maps and advises the
+// kernel about the access pattern; the destructor unmaps, and the
+// FileDescriptor member closes the file, also when the constructor throws
+// after opening it. The contents are handed out as spans into the page
+// cache, so reading a record never copies it into a user buffer.
+class MappedFile {
+public:
+  explicit MappedFile(std::string const& path, Access access = Access::normal,
+                      bool huge_pages = false)
+  : file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)}
+  {
+    if (file.get() < 0)
+      throw std::system_error{errno, std::generic_category(), "open " + path};
+
+    struct stat st;
+    if (::fstat(file.get(), &st) < 0)
+      throw std::system_error{errno, std::generic_category(), "fstat " + path};
+
+    // mmap rejects empty mappings; an empty file gives an empty span
+    length = static_cast<std::size_t>(st.st_size);
+    if (length > 0) {
+      void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file.get(), 0);
+      if (p == MAP_FAILED)
+        throw std::system_error{errno, std::generic_category(), "mmap " + path};
+      data = static_cast<std::byte*>(p);
+    }
+
+    advise(access);
+    if (huge_pages)
+      huge = advise_huge_pages();
+  }
+
+  ~MappedFile() {
+    if (data)
+      ::munmap(data, length);
+  }
+
+  MappedFile(MappedFile const&)            = delete;
+  MappedFile& operator=(MappedFile const&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept
+  : file{std::move(other.file)}
+  , data{std::exchange(other.data, nullptr)}
+  , length{std::exchange(other.length, 0)}
+  , huge{std::exchange(other.huge, false)}
+  { }
+
+  MappedFile& operator=(MappedFile&& other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  void swap(MappedFile& other) noexcept {
+    using std::swap;
+    swap(file,   other.file);
+    swap(data,   other.data);
+    swap(length, other.length);
+    swap(huge,   other.huge);
+  }
+
+  // Only a hint: a kernel that ignores it still returns the right data
+  void advise(Access access) const {
+    if (not data)
+      return;
+    int advice = access == Access::sequential ? MADV_SEQUENTIAL
+               : access == Access::random     ? MADV_RANDOM
+               :                                MADV_NORMAL;
+    ::madvise(data, length, advice);
+  }
+
+  std::span<std::byte const> bytes() const { return {data, length}; }
+  std::size_t                size()  const { return length; }
+
+  // Whether the kernel accepted the huge page request
+  bool huge_pages() const { return huge; }
+
+  // Views the file as an array of fixed-size records; a trailing partial
+  // record is ignored. The mapping is page aligned, so any T with
+  // alignment up to a page is correctly aligned.
+  template <class T>
+  std::span<T const> records() const {
+    static_assert(std::is_trivially_copyable_v<T>, "records must be trivially copyable");
+    return {reinterpret_cast<T const*>(data), length / sizeof(T)};
+  }
+
+  // Calls f(std::string_view) for every newline-terminated record; the
+  // views point into the mapping and stay valid as long as the file does
+  template <class F>
+  void for_each_line(F&& f) const {
+    auto const* first = reinterpret_cast<char const*>(data);
+    auto const* last  = first + length;
+    while (first != last) {
+      auto const* eol = static_cast<char const*>(std::memchr(first, '\n', static_cast<std::size_t>(last - first)));
+      auto const* end = eol ? eol : last;
+      f(std::string_view{first, static_cast<std::size_t>(end - first)});
+      first = eol ? eol + 1 : last;
+    }
+  }
+
+private:
+  // Transparent huge pages for file-backed mappings need kernel support for
+  // huge pages in the page cache; where that is missing madvise fails and
+  // the mapping keeps using normal pages
+  bool advise_huge_pages() const {
+#ifdef MADV_HUGEPAGE
+    return data and ::madvise(data, length, MADV_HUGEPAGE) == 0;
+#else
+    return false;
+#endif
+  }
+
+  FileDescriptor file;
+  std::byte*     data{nullptr};
+  std::size_t    length{0};
+  bool           huge{false};
+};
+
+//
+// Client code
+
+long fib(int n)
+{
+  trace::Span span{"fib"};
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+
+void client(int n)
+{
+  trace::Span span{"client"};
+  {
+    trace::Span inner{"compute"};
+    fib(n);
+  }
+  {
+    trace::Span inner{"sleep"};
+    std::this_thread::sleep_for(std::chrono::milliseconds{2});
+  }
+}
+
+void client(MappedFile const& file)
+{
+  int n = 0;
+  file.for_each_line([&](std::string_view line) {
+    std::cout << "line " << ++n << ": " << line << std::endl;
+  });
+}
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Runs n iterations of a tiny loop body, optionally inside a span. Work is
+// done in batches that fit the ring, which is drained between batches
+// outside the timed region.
+double span_loop(std::size_t n, bool with_span)
+{
+  static volatile int sink = 0;
+  std::size_t const batch = trace::Ring::capacity / 2;
+  double total = 0;
+  for (std::size_t done = 0; done < n; done += batch) {
+    total += time_ms([&] {
+      for (std::size_t i = 0; i < batch; ++i) {
+        if (with_span) {
+          trace::Span span{"bench"};
+          sink = sink + 1;
+        }
+        else {
+          sink = sink + 1;
+        }
+      }
+    });
+    trace::drain([](trace::Event const&, std::uint32_t) { });
+  }
+  return total;
+}
+
+// A file in the temporary directory, removed when the object goes out of
+// scope, including when an exception unwinds past it
+class TempFile {
+public:
+  explicit TempFile(std::string const& name)
+    : file_path{(std::filesystem::temp_directory_path() / name).string()} { }
+
+  ~TempFile() {
+    std::error_code ec;
+    std::filesystem::remove(file_path, ec);
+  }
+
+  TempFile(TempFile const&)            = delete;
+  TempFile& operator=(TempFile const&) = delete;
+
+  std::string const& path() const { return file_path; }
+
+private:
+  std::string file_path;
+};
+
+struct Record {
+  std::uint64_t key;
+  double        value;
+};
+
+void write_records(std::string const& path, std::size_t count)
+{
+  std::ofstream out{path, std::ios::binary};
+  std::vector<Record> chunk(1 << 16);
+  for (std::size_t done = 0; done < count; done += chunk.size()) {
+    std::size_t n = std::min(chunk.size(), count - done);
+    for (std::size_t i = 0; i < n; ++i)
+      chunk[i] = {done + i, static_cast<double>((done + i) % 1000)};
+    out.write(reinterpret_cast<char const*>(chunk.data()), static_cast<std::streamsize>(n * sizeof(Record)));
+  }
+  if (not out)
+    throw std::runtime_error{"cannot write " + path};
+}
+
+double sum_ifstream(std::string const& path)
+{
+  std::ifstream in{path, std::ios::binary};
+  std::vector<Record> buffer(std::size_t{1} << 16);   // 1 MiB
+  double sum = 0;
+  while (in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(Record)))
+         or in.gcount() > 0) {
+    auto n = static_cast<std::size_t>(in.gcount()) / sizeof(Record);
+    for (std::size_t i = 0; i < n; ++i)
+      sum += buffer[i].value;
+  }
+  return sum;
+}
+
+double sum_mapped(MappedFile const& file)
+{
+  double sum = 0;
+  for (auto const& r : file.records<Record>())
+    sum += r.value;
+  return sum;
+}
+
+// Usage: 1_raii [size of the benchmark file in MiB, e.g. 8192]
+int main(int argc, char* argv[])
+{
+  long long const mib = argc > 1 ? std::atoll(argv[1]) : 1024;
+  if (mib < 1) {
+    std::cerr << "usage: " << argv[0] << " [size of the benchmark file in MiB, at least 1]" << std::endl;
+    return 1;
+  }
+
+  // Client usage: two threads write to one trace file
+  std::string const trace_path = (std::filesystem::temp_directory_path() / "raii_trace.json").string();
+  {
+    trace::Flusher flusher{trace_path};
+    std::thread t{[] { client(12); }};
+    client(14);
+    t.join();
+    // flusher writes the remaining events when it goes out of scope
+  }
+  std::cout << "wrote " << trace_path << " (" << trace::dropped() << " events dropped)" << std::endl;
+
+  // Benchmark
+  std::size_t const n = std::size_t{1} << 24;
+
+  double base = span_loop(n, false);
+  trace::enabled = false;
+  double off  = span_loop(n, true);
+  trace::enabled = true;
+  double on   = span_loop(n, true);
+
+  // A recording span reads the timestamp twice; under some hypervisors the
+  // TSC read is trapped and dominates the cost
+  std::uint64_t stamps = 0;
+  double clock = time_ms([&] {
+    for (std::size_t i = 0; i < n; ++i)
+      stamps += trace::now() & 1;
+  });
+
+  auto per_span = [&](double t) { return (t - base) * 1e6 / static_cast<double>(n); };
+  std::cout << "\nBenchmark: " << n << " spans"
+            << "\nloop without spans: " << base << " ms"
+            << "\ndisabled spans:     " << off  << " ms (" << per_span(off) << " ns/span)"
+            << "\nrecording spans:    " << on   << " ms (" << per_span(on)  << " ns/span)"
+            << "\ntimestamp read:     " << clock * 1e6 / static_cast<double>(n) << " ns"
+            << " (" << trace::ticks_per_us() << " ticks per us, checksum " << stamps << ")" << std::endl;
+
+  // Client usage: zero-copy line records
+  {
+    TempFile text{"raii_lines.txt"};
+    std::ofstream{text.path()} << "first record\nsecond record\nthird record\n";
+    MappedFile lines{text.path(), Access::sequential};
+    MappedFile moved{std::move(lines)};
+    std::cout << std::endl;
+    client(moved);
+  }
+
+  // Benchmark: fixed-size records, read through the page cache. The file is
+  // read once before timing so every method sees a warm cache; for cold
+  // reads drop the page cache between runs (as root)
+  std::size_t const count = (static_cast<std::size_t>(mib) << 20) / sizeof(Record);
+  double const      bytes = static_cast<double>(count * sizeof(Record));
+  TempFile const    file{"raii_records.bin"};
+  std::string const path  = file.path();
+  write_records(path, count);
+
+  double s_stream{}, s_map{}, s_huge{};
+  sum_ifstream(path);
+  double t_stream = time_ms([&] { s_stream = sum_ifstream(path); });
+
+  MappedFile seq{path, Access::sequential};
+  double t_map = time_ms([&] { s_map = sum_mapped(seq); });
+
+  MappedFile huge{path, Access::sequential, true};
+  double t_huge = time_ms([&] { s_huge = sum_mapped(huge); });
+
+  // Random access: one record at a time at random positions
+  std::size_t const lookups = 1'000'000;
+  std::vector<std::size_t> index(lookups);
+  std::mt19937_64 rng{7};
+  std::uniform_int_distribution<std::size_t> dist{0, count - 1};
+  for (auto& i : index)
+    i = dist(rng);
+
+  double r_stream{}, r_map{};
+  double t_rstream = time_ms([&] {
+    std::ifstream in{path, std::ios::binary};
+    Record r;
+    for (auto i : index) {
+      in.seekg(static_cast<std::streamoff>(i * sizeof(Record)));
+      in.read(reinterpret_cast<char*>(&r), sizeof r);
+      r_stream += r.value;
+    }
+  });
+
+  MappedFile rnd{path, Access::random};
+  double t_rmap = time_ms([&] {
+    auto records = rnd.records<Record>();
+    for (auto i : index)
+      r_map += records[i].value;
+  });
+
+  auto gbps = [&](double ms) { return bytes / ms / 1e6; };
+  std::cout << "\nBenchmark: " << mib << " MiB of " << sizeof(Record) << "-byte records"
+            << "\nsequential, ifstream (1 MiB reads): " << t_stream << " ms, " << gbps(t_stream) << " GB/s"
+            << "\nsequential, MappedFile:             " << t_map    << " ms, " << gbps(t_map)    << " GB/s"
+            << "\nsequential, MappedFile huge pages:  " << t_huge   << " ms, " << gbps(t_huge)   << " GB/s"
+            << " (huge pages " << (huge.huge_pages() ? "accepted" : "unavailable") << ")"
+            << "\nrandom " << lookups << " lookups, ifstream:   " << t_rstream << " ms"
+            << "\nrandom " << lookups << " lookups, MappedFile: " << t_rmap    << " ms"
+            << "\nchecksums: " << s_stream << " " << s_map << " " << s_huge
+            << ", " << r_stream << " " << r_map << std::endl;
+}
@@ -1,7 +1,254 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+//
+// Fast pimpl storage
+
+// Holds a T in an aligned buffer inside the owning object instead of on
+// the heap. T only needs to be complete where the special members are
+// instantiated, i.e. in the translation unit that defines the owner's
+// special members, so the header still hides T like a classic pimpl.
+// Size may be larger than sizeof(T), which leaves room for the hidden type
+// to grow without changing the owner's layout; the checks in validate()
+// fire at compile time, in that translation unit, if it outgrows Size,
+// needs a stricter alignment or can throw when moved (the moves below are
+// noexcept, as the owner's usually are, so a throwing move would
+// terminate).
+template <class T, std::size_t Size, std::size_t Align>
+class FastPimpl {
+public:
+  template <class... Args>
+  explicit FastPimpl(std::in_place_t, Args&&... args) {
+    validate<sizeof(T), alignof(T)>();
+    ::new (static_cast<void*>(storage)) T(std::forward<Args>(args)...);
+  }
+
+  FastPimpl(FastPimpl const& other)     { ::new (static_cast<void*>(storage)) T(*other); }
+  FastPimpl(FastPimpl&& other) noexcept { ::new (static_cast<void*>(storage)) T(std::move(*other)); }
+
+  FastPimpl& operator=(FastPimpl const& other) {
+    **this = *other;
+    return *this;
+  }
+
+  FastPimpl& operator=(FastPimpl&& other) noexcept {
+    **this = std::move(*other);
+    return *this;
+  }
+
+  ~FastPimpl() { get()->~T(); }
+
+  T*       operator->()       noexcept { return get(); }
+  T const* operator->() const noexcept { return get(); }
+  T&       operator*()        noexcept { return *get(); }
+  T const& operator*()  const noexcept { return *get(); }
+
+private:
+  // The actual values appear in the template arguments of the error
+  template <std::size_t ActualSize, std::size_t ActualAlign>
+  static constexpr void validate() noexcept {
+    static_assert(Size >= ActualSize, "FastPimpl: Size is smaller than sizeof(T)");
+    static_assert(Align % ActualAlign == 0, "FastPimpl: Align is not a multiple of alignof(T)");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "FastPimpl: T's move constructor can throw");
+    static_assert(std::is_nothrow_move_assignable_v<T>, "FastPimpl: T's move assignment can throw");
+  }
+
+  T*       get()       noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+  T const* get() const noexcept { return std::launder(reinterpret_cast<T const*>(storage)); }
+
+  alignas(Align) std::byte storage[Size];
+};
+
+//
+// Classic pimpl (widget.h)
+
+namespace pointer {
+
+class Widget {
+public:
+  Widget(int i, std::string s);
+  Widget(Widget const& other);
+  Widget(Widget&& other) noexcept;
+  Widget& operator=(Widget const& other);
+  Widget& operator=(Widget&& other) noexcept;
+  ~Widget();
+
+  int         get_idx() const;
+  std::string get_str() const;
+  int         compute(int x) const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> pimpl;
+};
+
+} // namespace pointer
+
+//
+// Fast pimpl (widget.h)
+
+class Widget {
+public:
+  Widget(int i, std::string s);
+  Widget(Widget const& other);
+  Widget(Widget&& other) noexcept;
+  Widget& operator=(Widget const& other);
+  Widget& operator=(Widget&& other) noexcept;
+  ~Widget();
+
+  int         get_idx() const;
+  std::string get_str() const;
+  int         compute(int x) const;
+
+private:
+  struct Impl;
+  // 64 bytes reserve room for Impl to grow; Impl itself is 48 bytes with
+  // libstdc++ on x86-64
+  FastPimpl<Impl, 64, 8> pimpl;
+};
+
+//
+// Implementation (widget.cxx)
+
+struct Resource {
+  int x{5};
+  int y{7};
+};
+
+namespace pointer {
+
+struct Widget::Impl {
+  int         idx;
+  std::string str;
+  Resource    res;
+};
+
+Widget::Widget(int i, std::string s)
+  : pimpl{std::make_unique<Impl>(Impl{i, std::move(s), {i, 2 * i}})} { }
+
+Widget::Widget(Widget const& other) : pimpl{std::make_unique<Impl>(*other.pimpl)} { }
+Widget::Widget(Widget&& other) noexcept = default;
+
+Widget& Widget::operator=(Widget const& other) {
+  *pimpl = *other.pimpl;
+  return *this;
+}
+
+Widget& Widget::operator=(Widget&& other) noexcept = default;
+Widget::~Widget() = default;
+
+int         Widget::get_idx() const      { return pimpl->idx; }
+std::string Widget::get_str() const      { return pimpl->str; }
+int         Widget::compute(int x) const { return pimpl->idx * x + pimpl->res.x - pimpl->res.y; }
+
+} // namespace pointer
+
+struct Widget::Impl {
+  int         idx;
+  std::string str;
+  Resource    res;
+};
+
+Widget::Widget(int i, std::string s)
+  : pimpl{std::in_place, Impl{i, std::move(s), {i, 2 * i}}} { }
+
+Widget::Widget(Widget const& other) = default;
+Widget::Widget(Widget&& other) noexcept = default;
+Widget& Widget::operator=(Widget const& other) = default;
+Widget& Widget::operator=(Widget&& other) noexcept = default;
+Widget::~Widget() = default;
+
+int         Widget::get_idx() const      { return pimpl->idx; }
+std::string Widget::get_str() const      { return pimpl->str; }
+int         Widget::compute(int x) const { return pimpl->idx * x + pimpl->res.x - pimpl->res.y; }
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Client code
+template <class W>
+void client(W const& w)
+{
+  std::cout << "idx = " << w.get_idx() << ", str = " << w.get_str()
+            << ", compute(3) = " << w.compute(3) << std::endl;
+}
+
+struct Result {
+  double construct_ms;
+  double access_ms;
+  double shuffled_ms;
+  long   checksum;
+};
+
+template <class W>
+Result run(std::size_t n, int reps)
+{
+  std::vector<W> widgets;
+  widgets.reserve(n);
+
+  Result r{};
+  r.construct_ms = time_ms([&] {
+    for (std::size_t i = 0; i < n; ++i)
+      widgets.emplace_back(static_cast<int>(i % 1000), "w");
+  });
+
+  auto access = [&] {
+    for (int k = 0; k < reps; ++k)
+      for (auto const& w : widgets)
+        r.checksum += w.compute(k);
+  };
+  r.access_ms = time_ms(access);
+
+  // Reordering the widgets, as sorting or churn does in a long-lived
+  // container, scatters the heap-allocated implementations
+  std::shuffle(widgets.begin(), widgets.end(), std::mt19937{42});
+  r.shuffled_ms = time_ms(access);
+  return r;
+}
 
 int main()
 {
-  
-}
\ No newline at end of file
+  // Client usage
+  pointer::Widget p{1, "classic"};
+  Widget          w{2, "fast"};
+  Widget          copy{w};
+  client(p);
+  client(copy);
+
+  std::cout << "\nsizeof(pointer::Widget) = " << sizeof(pointer::Widget)
+            << ", sizeof(Widget) = " << sizeof(Widget) << std::endl;
+
+  // Benchmark
+  std::size_t const n    = 1'000'000;
+  int         const reps = 20;
+
+  auto classic = run<pointer::Widget>(n, reps);
+  auto fast    = run<Widget>(n, reps);
+
+  std::cout << "\nBenchmark: " << n << " widgets, " << reps << " passes of compute()"
+            << "\nconstruct: unique_ptr pimpl " << classic.construct_ms << " ms, fast pimpl "
+            << fast.construct_ms << " ms"
+            << "\naccess:    unique_ptr pimpl " << classic.access_ms << " ms, fast pimpl "
+            << fast.access_ms << " ms"
+            << "\nshuffled:  unique_ptr pimpl " << classic.shuffled_ms << " ms, fast pimpl "
+            << fast.shuffled_ms << " ms"
+            << "\nchecksums: " << classic.checksum << " " << fast.checksum << std::endl;
+}
@@ -1,7 +1,347 @@
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
+//
+// Instrumentation for NVI entry points
+
+// The public non-virtual function of an NVI class is the single place every
+// call goes through, so it is where instrumentation belongs: nvi::call()
+// wraps the private virtual and, depending on the compile-time Flags,
+// counts calls, records the latency in a histogram and counts exceptions.
+// With Flags == none it is a plain forward and no state is touched.
+namespace nvi {
+
+enum Flags : unsigned {
+  none    = 0,
+  count   = 1 << 0,
+  latency = 1 << 1,
+  errors  = 1 << 2,
+  all     = count | latency | errors
+};
+
+// Log-linear (HDR-style) latency histogram in nanoseconds. Values below
+// 2^sub_bits have their own bucket; every power-of-two range above that is
+// split into 2^sub_bits linear buckets, so a bucket's lower bound is within
+// 1/2^sub_bits of any value in it.
+struct Histogram {
+  static constexpr int         sub_bits = 4;
+  static constexpr std::size_t sub      = std::size_t{1} << sub_bits;
+  static constexpr std::size_t buckets  = (64 - sub_bits + 1) * sub;
+
+  static std::size_t bucket_of(std::uint64_t ns) {
+    if (ns < sub)
+      return static_cast<std::size_t>(ns);
+    int shift = std::bit_width(ns) - 1 - sub_bits;
+    return (static_cast<std::size_t>(shift + 1) << sub_bits) + ((ns >> shift) & (sub - 1));
+  }
+
+  static std::uint64_t lower_bound(std::size_t b) {
+    if (b < sub)
+      return b;
+    int shift = static_cast<int>(b >> sub_bits) - 1;
+    return (sub + (b & (sub - 1))) << shift;
+  }
+};
+
+// Counters for one entry point and one thread. Only the owning thread
+// writes, so increments are a relaxed load and store rather than a locked
+// read-modify-write; readers may load concurrently.
+struct ThreadStats {
+  using Counter = std::atomic<std::uint64_t>;
+
+  static void bump(Counter& c) {
+    c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  Counter                                calls{0};
+  Counter                                failures{0};
+  std::array<Counter, Histogram::buckets> histogram{};
+};
+
+struct Snapshot {
+  std::uint64_t                                calls{0};
+  std::uint64_t                                failures{0};
+  std::uint64_t                                timed{0};
+  std::array<std::uint64_t, Histogram::buckets> histogram{};
+
+  // Approximate latency at quantile q in [0, 1]
+  std::uint64_t percentile(double q) const {
+    auto rank = static_cast<std::uint64_t>(q * static_cast<double>(timed));
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < histogram.size(); ++b) {
+      seen += histogram[b];
+      if (seen > rank)
+        return Histogram::lower_bound(b);
+    }
+    return 0;
+  }
+};
+
+// Statistics of one entry point, aggregated over threads on read
+class CallStats {
+public:
+  static constexpr std::size_t max_sites = 64;
+
+  explicit CallStats(std::string name) : site_name{std::move(name)}, id{next_id++} {
+    if (id >= max_sites)
+      throw std::length_error{"nvi::CallStats: too many call sites"};
+  }
+
+  CallStats(CallStats const&)            = delete;
+  CallStats& operator=(CallStats const&) = delete;
+
+  // Per-thread counters of this call site, created on a thread's first call
+  ThreadStats& local() {
+    thread_local std::array<ThreadStats*, max_sites> slots{};
+    auto& slot = slots[id];
+    if (not slot) {
+      std::lock_guard lock{mutex};
+      threads.push_back(std::make_unique<ThreadStats>());
+      slot = threads.back().get();
+    }
+    return *slot;
+  }
+
+  Snapshot snapshot() const {
+    Snapshot s;
+    std::lock_guard lock{mutex};
+    for (auto const& t : threads) {
+      s.calls    += t->calls.load(std::memory_order_relaxed);
+      s.failures += t->failures.load(std::memory_order_relaxed);
+      for (std::size_t b = 0; b < Histogram::buckets; ++b) {
+        auto n = t->histogram[b].load(std::memory_order_relaxed);
+        s.histogram[b] += n;
+        s.timed        += n;
+      }
+    }
+    return s;
+  }
+
+  std::string const& name() const { return site_name; }
+
+private:
+  // Call sites are static objects, constructed before threads start
+  inline static std::size_t next_id = 0;
+
+  std::string                               site_name;
+  std::size_t                               id;
+  mutable std::mutex                        mutex;
+  std::vector<std::unique_ptr<ThreadStats>> threads;   // owned here, so they outlive their threads
+};
+
+template <unsigned F, class Impl>
+decltype(auto) call(CallStats& stats, Impl&& impl)
+{
+  if constexpr (F == none) {
+    return impl();
+  }
+  else {
+    using Clock = std::chrono::steady_clock;
+    ThreadStats& t = stats.local();
+    if constexpr ((F & count) != 0)
+      ThreadStats::bump(t.calls);
+
+    // Records the latency on every exit path, including exceptions
+    struct Timer {
+      ThreadStats&      t;
+      Clock::time_point start = (F & latency) != 0 ? Clock::now() : Clock::time_point{};
+      ~Timer() {
+        if constexpr ((F & latency) != 0) {
+          auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+          ThreadStats::bump(t.histogram[Histogram::bucket_of(static_cast<std::uint64_t>(ns))]);
+        }
+      }
+    } timer{t};
+
+    if constexpr ((F & errors) != 0) {
+      try {
+        return impl();
+      }
+      catch (...) {
+        ThreadStats::bump(t.failures);
+        throw;
+      }
+    }
+    else {
+      return impl();
+    }
+  }
+}
+
+} // namespace nvi
+
+//
+// NVI class
+
+// The public interface is non-virtual and instrumented; derived classes
+// only override the private virtual implementations
+template <unsigned Flags>
+class Shape {
+public:
+  virtual ~Shape() = default;
+
+  double area() const {
+    return nvi::call<Flags>(area_stats, [this] { return do_area(); });
+  }
+
+  // Throws std::invalid_argument for a negative factor
+  void scale(double factor) {
+    nvi::call<Flags>(scale_stats, [&] { do_scale(factor); });
+  }
+
+  inline static nvi::CallStats area_stats{"Shape::area"};
+  inline static nvi::CallStats scale_stats{"Shape::scale"};
+
+private:
+  virtual double do_area() const = 0;
+  virtual void   do_scale(double factor) = 0;
+};
+
+template <unsigned Flags>
+class Circle : public Shape<Flags> {
+public:
+  explicit Circle(double r) : radius{r} { }
+
+private:
+  double do_area() const override { return 3.14159265358979 * radius * radius; }
+
+  void do_scale(double factor) override {
+    if (factor < 0)
+      throw std::invalid_argument{"negative scale factor"};
+    radius *= factor;
+  }
+
+  double radius;
+};
+
+template <unsigned Flags>
+class Square : public Shape<Flags> {
+public:
+  explicit Square(double s) : side{s} { }
+
+private:
+  double do_area() const override { return side * side; }
+
+  void do_scale(double factor) override {
+    if (factor < 0)
+      throw std::invalid_argument{"negative scale factor"};
+    side *= factor;
+  }
+
+  double side;
+};
+
+void print_stats(nvi::CallStats const& stats)
+{
+  auto s = stats.snapshot();
+  std::cout << stats.name() << ": " << s.calls << " calls, " << s.failures << " errors";
+  if (s.timed > 0)
+    std::cout << ", p50 " << s.percentile(0.50) << " ns, p99 " << s.percentile(0.99)
+              << " ns, p99.9 " << s.percentile(0.999) << " ns";
+  std::cout << std::endl;
+}
+
+// Client code
+template <unsigned Flags>
+void client(Shape<Flags>& shape)
+{
+  shape.scale(2.0);
+  std::cout << "area after scale(2) = " << shape.area() << std::endl;
+  try {
+    shape.scale(-1.0);
+  }
+  catch (std::invalid_argument const& e) {
+    std::cout << "scale(-1) threw: " << e.what() << std::endl;
+  }
+}
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Shapes are created from runtime input, so area() stays an indirect call
+template <unsigned Flags>
+std::vector<std::unique_ptr<Shape<Flags>>> make_shapes(std::size_t n)
+{
+  std::vector<std::unique_ptr<Shape<Flags>>> shapes;
+  for (std::size_t i = 0; i < n; ++i) {
+    if (i % 3 == 0)
+      shapes.push_back(std::make_unique<Circle<Flags>>(static_cast<double>(i % 7)));
+    else
+      shapes.push_back(std::make_unique<Square<Flags>>(static_cast<double>(i % 5)));
+  }
+  return shapes;
+}
+
+template <unsigned Flags>
+double area_loop(std::size_t n, int reps, double& sum)
+{
+  auto shapes = make_shapes<Flags>(n);
+  return time_ms([&] {
+    for (int r = 0; r < reps; ++r)
+      for (auto const& s : shapes)
+        sum += s->area();
+  });
+}
 
 int main()
 {
-  
-}
\ No newline at end of file
+  // Client usage: two threads share the call-site statistics
+  Circle<nvi::all> circle{1.0};
+  Square<nvi::all> square{2.0};
+  client(circle);
+  std::thread t{[&] { client(square); }};
+  t.join();
+  for (int i = 0; i < 1000; ++i)
+    circle.area();
+
+  std::cout << std::endl;
+  print_stats(Shape<nvi::all>::area_stats);
+  print_stats(Shape<nvi::all>::scale_stats);
+
+  // Benchmark
+  std::size_t const n    = 1'000;
+  int         const reps = 10'000;
+  double const calls = static_cast<double>(n) * reps;
+
+  double s0{}, s1{}, s2{};
+  double t_none  = area_loop<nvi::none>(n, reps, s0);
+  double t_count = area_loop<nvi::count | nvi::errors>(n, reps, s1);
+  double t_all   = area_loop<nvi::all>(n, reps, s2);
+
+  // Latency recording reads the clock twice per call, which dominates its
+  // cost where clock reads are slow (e.g. under some hypervisors)
+  std::chrono::steady_clock::rep ticks = 0;
+  double t_clock = time_ms([&] {
+    for (int i = 0; i < 1'000'000; ++i)
+      ticks += std::chrono::steady_clock::now().time_since_epoch().count() & 1;
+  });
+
+  auto ns = [&](double ms) { return ms * 1e6 / calls; };
+  std::cout << "\nBenchmark: " << calls << " calls to area()"
+            << "\nno instrumentation:  " << t_none  << " ms (" << ns(t_none)  << " ns/call)"
+            << "\ncalls and errors:    " << t_count << " ms (" << ns(t_count) << " ns/call)"
+            << "\ncalls, errors, time: " << t_all   << " ms (" << ns(t_all)   << " ns/call)"
+            << "\nclock read:          " << t_clock << " ns"
+            << "\nchecksums: " << s0 << " " << s1 << " " << s2 << " " << ticks << std::endl;
+  print_stats(Shape<nvi::all>::area_stats);
+}
@@ -1,7 +1,414 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <latch>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
+//
+// Thread pool
+
+class ThreadPool {
+public:
+  explicit ThreadPool(std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i)
+      threads.emplace_back([this] { worker_loop(); });
+  }
+
+  ~ThreadPool()
+  {
+    {
+      std::lock_guard lock{mutex};
+      stop = true;
+    }
+    ready.notify_all();
+    for (auto& t : threads)
+      t.join();
+  }
+
+  ThreadPool(ThreadPool const&)            = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  void submit(std::function<void()> task)
+  {
+    {
+      std::lock_guard lock{mutex};
+      tasks.push(std::move(task));
+    }
+    ready.notify_one();
+  }
+
+  std::size_t size() const { return threads.size(); }
+
+  // Whether the calling thread is a worker of some ThreadPool
+  static bool on_worker_thread() { return is_worker; }
+
+private:
+  void worker_loop()
+  {
+    is_worker = true;
+    for (;;) {
+      std::function<void()> task;
+      {
+        std::unique_lock lock{mutex};
+        ready.wait(lock, [this] { return stop or not tasks.empty(); });
+        if (stop and tasks.empty())
+          return;
+        task = std::move(tasks.front());
+        tasks.pop();
+      }
+      task();
+    }
+  }
+
+  inline static thread_local bool is_worker{false};
+
+  std::vector<std::thread>          threads;
+  std::queue<std::function<void()>> tasks;
+  std::mutex                        mutex;
+  std::condition_variable           ready;
+  bool                              stop{false};
+};
+
+//
+// Execution backends
+
+namespace algo {
+
+// Execution tags
+struct sequential_tag { };   // any input iterator, one element at a time
+struct simd_tag       { };   // contiguous ranges, unrolled over raw pointers
+struct parallel_tag   { };   // random-access ranges, split across the pool
+                             // (single-threaded when nested in a pool task)
+
+inline constexpr sequential_tag seq{};
+inline constexpr simd_tag       simd{};
+inline constexpr parallel_tag   par{};
+
+// The tag actually used when Requested is asked for on iterators Its...:
+// a backend the iterators cannot support falls back to sequential_tag, so
+// e.g. a std::list never reaches the pointer-based simd path
+template <class Requested, class... Its>
+struct select_tag { using type = sequential_tag; };
+
+template <class... Its>
+struct select_tag<simd_tag, Its...> {
+  using type = std::conditional_t<(std::contiguous_iterator<Its> and ...), simd_tag, sequential_tag>;
+};
+
+template <class... Its>
+struct select_tag<parallel_tag, Its...> {
+  using type = std::conditional_t<(std::random_access_iterator<Its> and ...), parallel_tag, sequential_tag>;
+};
+
+template <class Requested, class... Its>
+using select_tag_t = typename select_tag<Requested, Its...>::type;
+
+// Without an explicit request: the fastest single-threaded backend
+template <class... Its>
+using default_tag_t = select_tag_t<simd_tag, Its...>;
+
+constexpr char const* tag_name(sequential_tag) { return "sequential"; }
+constexpr char const* tag_name(simd_tag)       { return "simd"; }
+constexpr char const* tag_name(parallel_tag)   { return "parallel"; }
+
+ThreadPool& pool()
+{
+  static ThreadPool p{std::max(1u, std::thread::hardware_concurrency())};
+  return p;
+}
+
+namespace detail {
+
+// Ranges smaller than this are not worth a task
+inline constexpr std::ptrdiff_t min_chunk = std::ptrdiff_t{1} << 14;
+
+// Calls body(begin, end, index) for consecutive chunks of [first, last) on
+// the pool and waits; the first exception thrown by a chunk is rethrown.
+// Called from a pool task (a parallel algorithm nested in another), the
+// whole range runs on the calling thread: waiting for chunks queued behind
+// the caller could block every worker and deadlock the pool.
+template <class It, class Body>
+void parallel_chunks(It first, It last, Body body)
+{
+  auto const n      = last - first;
+  auto const chunks = std::clamp<std::ptrdiff_t>(n / min_chunk, 1, static_cast<std::ptrdiff_t>(pool().size()) * 4);
+  if (chunks == 1 or ThreadPool::on_worker_thread()) {
+    body(first, last, 0);
+    return;
+  }
+
+  std::mutex         mutex;
+  std::exception_ptr error;
+  std::latch         done{chunks};
+  for (std::ptrdiff_t c = 0; c < chunks; ++c) {
+    pool().submit([&, c] {
+      try {
+        body(first + n * c / chunks, first + n * (c + 1) / chunks, c);
+      }
+      catch (...) {
+        std::lock_guard lock{mutex};
+        if (not error)
+          error = std::current_exception();
+      }
+      done.count_down();
+    });
+  }
+  done.wait();
+  if (error)
+    std::rethrow_exception(error);
+}
+
+// for_each
+
+template <class It, class F>
+void for_each(sequential_tag, It first, It last, F& f)
+{
+  for (; first != last; ++first)
+    f(*first);
+}
+
+template <class It, class F>
+void for_each(simd_tag, It first, It last, F& f)
+{
+  auto* p = std::to_address(first);
+  auto const n = last - first;
+  std::ptrdiff_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    f(p[i]);
+    f(p[i + 1]);
+    f(p[i + 2]);
+    f(p[i + 3]);
+  }
+  for (; i < n; ++i)
+    f(p[i]);
+}
+
+template <class It, class F>
+void for_each(parallel_tag, It first, It last, F& f)
+{
+  parallel_chunks(first, last, [&](It b, It e, std::ptrdiff_t) {
+    for_each(default_tag_t<It>{}, b, e, f);
+  });
+}
+
+// transform
+
+template <class It, class Out, class F>
+void transform(sequential_tag, It first, It last, Out out, F& f)
+{
+  for (; first != last; ++first, ++out)
+    *out = f(*first);
+}
+
+template <class It, class Out, class F>
+void transform(simd_tag, It first, It last, Out out, F& f)
+{
+  auto* p = std::to_address(first);
+  auto* q = std::to_address(out);
+  auto const n = last - first;
+  std::ptrdiff_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    q[i]     = f(p[i]);
+    q[i + 1] = f(p[i + 1]);
+    q[i + 2] = f(p[i + 2]);
+    q[i + 3] = f(p[i + 3]);
+  }
+  for (; i < n; ++i)
+    q[i] = f(p[i]);
+}
+
+template <class It, class Out, class F>
+void transform(parallel_tag, It first, It last, Out out, F& f)
+{
+  parallel_chunks(first, last, [&](It b, It e, std::ptrdiff_t) {
+    transform(default_tag_t<It, Out>{}, b, e, out + (b - first), f);
+  });
+}
+
+// reduce
+
+template <class It, class T, class Op>
+T reduce(sequential_tag, It first, It last, T init, Op& op)
+{
+  for (; first != last; ++first)
+    init = op(init, *first);
+  return init;
+}
+
+// Eight independent accumulators break the dependency chain of a serial
+// fold, so several operations are in flight at once and the compiler can
+// keep the accumulators in registers
+template <class It, class T, class Op>
+T reduce(simd_tag, It first, It last, T init, Op& op)
+{
+  auto* p = std::to_address(first);
+  auto const n = last - first;
+  if (n < 16)
+    return reduce(sequential_tag{}, p, p + n, init, op);
+
+  T a0 = p[0], a1 = p[1], a2 = p[2], a3 = p[3];
+  T a4 = p[4], a5 = p[5], a6 = p[6], a7 = p[7];
+  std::ptrdiff_t i = 8;
+  for (; i + 8 <= n; i += 8) {
+    a0 = op(a0, p[i]);
+    a1 = op(a1, p[i + 1]);
+    a2 = op(a2, p[i + 2]);
+    a3 = op(a3, p[i + 3]);
+    a4 = op(a4, p[i + 4]);
+    a5 = op(a5, p[i + 5]);
+    a6 = op(a6, p[i + 6]);
+    a7 = op(a7, p[i + 7]);
+  }
+
+  init = op(init, op(op(op(a0, a4), op(a2, a6)), op(op(a1, a5), op(a3, a7))));
+  return reduce(sequential_tag{}, p + i, p + n, init, op);
+}
+
+template <class It, class T, class Op>
+T reduce(parallel_tag, It first, It last, T init, Op& op)
+{
+  std::vector<T> partial(pool().size() * 4, init);
+  std::vector<char> used(partial.size(), 0);
+  parallel_chunks(first, last, [&](It b, It e, std::ptrdiff_t c) {
+    if (b == e)
+      return;
+    partial[c] = reduce(default_tag_t<It>{}, std::next(b), e, T(*b), op);
+    used[c]    = 1;
+  });
+  // Partial results are combined in range order
+  for (std::size_t c = 0; c < partial.size(); ++c)
+    if (used[c])
+      init = op(init, partial[c]);
+  return init;
+}
+
+} // namespace detail
+
+// Public interface. Without a tag the fastest single-threaded backend the
+// iterators allow is used; a requested tag is downgraded where the
+// iterators do not support it. reduce may regroup and reorder the
+// operations, so op must be associative and commutative (as for
+// std::reduce).
+
+template <class It, class F>
+void for_each(It first, It last, F f)
+{
+  detail::for_each(default_tag_t<It>{}, first, last, f);
+}
+
+template <class Tag, class It, class F>
+void for_each(Tag, It first, It last, F f)
+{
+  detail::for_each(select_tag_t<Tag, It>{}, first, last, f);
+}
+
+template <class It, class Out, class F>
+void transform(It first, It last, Out out, F f)
+{
+  detail::transform(default_tag_t<It, Out>{}, first, last, out, f);
+}
+
+template <class Tag, class It, class Out, class F>
+void transform(Tag, It first, It last, Out out, F f)
+{
+  detail::transform(select_tag_t<Tag, It, Out>{}, first, last, out, f);
+}
+
+template <class It, class T, class Op = std::plus<>>
+T reduce(It first, It last, T init, Op op = {})
+{
+  return detail::reduce(default_tag_t<It>{}, first, last, init, op);
+}
+
+template <class Tag, class It, class T, class Op = std::plus<>>
+T reduce(Tag, It first, It last, T init, Op op = {})
+{
+  return detail::reduce(select_tag_t<Tag, It>{}, first, last, init, op);
+}
+
+} // namespace algo
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Client code
+template <class Container>
+void client(char const* name, Container& c)
+{
+  using It = typename Container::iterator;
+  algo::transform(algo::par, c.begin(), c.end(), c.begin(), [](int x) { return x * x; });
+  std::cout << name << ": par runs as " << algo::tag_name(algo::select_tag_t<algo::parallel_tag, It>{})
+            << ", simd runs as " << algo::tag_name(algo::select_tag_t<algo::simd_tag, It>{})
+            << ", sum of squares = " << algo::reduce(algo::par, c.begin(), c.end(), 0L) << std::endl;
+}
 
 int main()
 {
-  
-}
\ No newline at end of file
+  // Client usage
+  std::vector<int> v(100);
+  std::iota(v.begin(), v.end(), 1);
+  std::deque<int> d(v.begin(), v.end());
+  std::list<int>  l(v.begin(), v.end());
+  client("vector", v);
+  client("deque ", d);
+  client("list  ", l);
+
+  // Benchmark: a cache-resident array and a large one, same total work
+  std::cout << "\nBenchmark: " << algo::pool().size() << " pool threads" << std::endl;
+  for (std::size_t n : {std::size_t{1} << 12, std::size_t{1} << 24}) {
+    int const reps = static_cast<int>((std::size_t{1} << 28) / n);
+    std::vector<double> a(n), b(n);
+    for (std::size_t i = 0; i < n; ++i)
+      a[i] = static_cast<double>(i % 1000) * 0.001;
+
+    // Read through volatile so that repeated passes are not merged
+    double* volatile in  = a.data();
+    double* volatile out = b.data();
+
+    std::cout << "\n" << reps << " passes over " << n << " doubles" << std::endl;
+    auto run = [&](auto tag) {
+      double sum = 0;
+      double t_for_each = time_ms([&] {
+        for (int r = 0; r < reps; ++r)
+          algo::for_each(tag, out, out + n, [](double& x) { x = x * 0.5 + 1.0; });
+      });
+      double t_transform = time_ms([&] {
+        for (int r = 0; r < reps; ++r)
+          algo::transform(tag, in, in + n, out, [](double x) { return x * 2.0 + 1.0; });
+      });
+      double t_reduce = time_ms([&] {
+        for (int r = 0; r < reps; ++r)
+          sum += algo::reduce(tag, in, in + n, 0.0);
+      });
+      std::cout << algo::tag_name(tag) << ":\tfor_each " << t_for_each << " ms, transform "
+                << t_transform << " ms, reduce " << t_reduce << " ms (sum " << sum / reps << ")" << std::endl;
+    };
+
+    run(algo::seq);
+    run(algo::simd);
+    run(algo::par);
+  }
+}
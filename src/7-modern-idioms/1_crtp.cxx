@@ -1,5 +1,307 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//
+// Naive vector (every operator materializes a temporary)
+
+namespace naive {
+
+struct Vector {
+  explicit Vector(std::size_t n, double value = 0) : data(n, value) { }
+
+  double  operator[](std::size_t i) const { return data[i]; }
+  double& operator[](std::size_t i)       { return data[i]; }
+  std::size_t size() const { return data.size(); }
+
+  std::vector<double> data;
+};
+
+template <class Op>
+Vector apply(Vector const& l, Vector const& r, Op op)
+{
+  Vector result(l.size());
+  for (std::size_t i = 0; i < l.size(); ++i)
+    result[i] = op(l[i], r[i]);
+  return result;
+}
+
+Vector operator+(Vector const& l, Vector const& r) { return apply(l, r, std::plus<>{}); }
+Vector operator-(Vector const& l, Vector const& r) { return apply(l, r, std::minus<>{}); }
+Vector operator*(Vector const& l, Vector const& r) { return apply(l, r, std::multiplies<>{}); }
+
+Vector operator*(double s, Vector const& v)
+{
+  Vector result(v.size());
+  for (std::size_t i = 0; i < v.size(); ++i)
+    result[i] = s * v[i];
+  return result;
+}
+
+Vector reverse(Vector const& v)
+{
+  Vector result(v.size());
+  for (std::size_t i = 0; i < v.size(); ++i)
+    result[i] = v[v.size() - 1 - i];
+  return result;
+}
+
+} // namespace naive
+
+//
+// Expression templates
+
+// Base class of every vector expression. Derived is the concrete node type,
+// so operator[] is resolved at compile time and a whole expression such as
+// b + c * d inlines into one loop body: no virtual calls, no temporaries.
+template <class Derived>
+struct VecExpr {
+  Derived const& derived() const { return static_cast<Derived const&>(*this); }
+
+  double      operator[](std::size_t i) const { return derived()[i]; }
+  std::size_t size()                    const { return derived().size(); }
+
+  // Whether the expression reads the storage at p at all
+  bool references(double const* p) const { return derived().references(p); }
+
+  // Whether element i of the expression reads storage at p other than p[i],
+  // which makes evaluating it in place into p unsafe
+  bool reads_across(double const* p) const { return derived().reads_across(p); }
+};
+
+// Leaf: a non-owning view of a Vector's elements. Nodes hold their
+// operands by value, and holding a raw pointer (rather than a reference to
+// the Vector) lets the compiler keep it in a register while the result is
+// being written.
+struct VectorRef : VecExpr<VectorRef> {
+  double const* p;
+  std::size_t   n;
+
+  VectorRef(double const* p, std::size_t n) : p{p}, n{n} { }
+
+  double      operator[](std::size_t i) const { return p[i]; }
+  std::size_t size()                    const { return n; }
+  bool references(double const* q)      const { return p == q; }
+  bool reads_across(double const*)      const { return false; }
+};
+
+struct Scalar : VecExpr<Scalar> {
+  double      value;
+  std::size_t n;
+
+  Scalar(double value, std::size_t n) : value{value}, n{n} { }
+
+  double      operator[](std::size_t)   const { return value; }
+  std::size_t size()                    const { return n; }
+  bool references(double const*)        const { return false; }
+  bool reads_across(double const*)      const { return false; }
+};
+
+template <class L, class R, class Op>
+struct Binary : VecExpr<Binary<L, R, Op>> {
+  L l;
+  R r;
+
+  Binary(L l, R r) : l{l}, r{r} { assert(l.size() == r.size()); }
+
+  double      operator[](std::size_t i) const { return Op{}(l[i], r[i]); }
+  std::size_t size()                    const { return l.size(); }
+  bool references(double const* p)      const { return l.references(p) or r.references(p); }
+  bool reads_across(double const* p)    const { return l.reads_across(p) or r.reads_across(p); }
+};
+
+template <class E>
+struct Reverse : VecExpr<Reverse<E>> {
+  E e;
+
+  explicit Reverse(E e) : e{e} { }
+
+  double      operator[](std::size_t i) const { return e[e.size() - 1 - i]; }
+  std::size_t size()                    const { return e.size(); }
+  bool references(double const* p)      const { return e.references(p); }
+  bool reads_across(double const* p)    const { return e.references(p); }
+};
+
+// Execution mode of an assignment
+enum class Eval {
+  automatic,   // parallel from Vector::parallel_threshold elements on
+  serial,
+  parallel
+};
+
+class Vector : public VecExpr<Vector> {
+public:
+  // Below this size starting threads costs more than it saves
+  static constexpr std::size_t parallel_threshold = std::size_t{1} << 18;
+
+  explicit Vector(std::size_t n, double value = 0) : data(n, value) { }
+
+  template <class E>
+  Vector(VecExpr<E> const& e) : data(e.size()) { assign(e); }
+
+  template <class E>
+  Vector& operator=(VecExpr<E> const& e) {
+    assign(e);
+    return *this;
+  }
+
+  // Evaluates e in one pass. If an element of e reads this vector at a
+  // different position (e.g. v = reverse(v)), the result is built in new
+  // storage first, so the assignment behaves as if e were evaluated before
+  // any element is written.
+  template <class E>
+  void assign(VecExpr<E> const& e, Eval mode = Eval::automatic) {
+    assert(e.size() == size());
+    if (e.reads_across(data.data())) {
+      Vector tmp(size());
+      tmp.assign(e, mode);
+      data.swap(tmp.data);
+      return;
+    }
+
+    E const expr = e.derived();
+    bool parallel = mode == Eval::parallel
+                 or (mode == Eval::automatic and size() >= parallel_threshold);
+    if (not parallel) {
+      evaluate(expr, 0, size());
+      return;
+    }
+
+    std::size_t const workers = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::jthread> threads;
+    for (std::size_t w = 1; w < workers; ++w)
+      threads.emplace_back([&, w] { evaluate(expr, size() * w / workers, size() * (w + 1) / workers); });
+    evaluate(expr, 0, size() / workers);
+  }
+
+  double  operator[](std::size_t i) const { return data[i]; }
+  double& operator[](std::size_t i)       { return data[i]; }
+  std::size_t size() const { return data.size(); }
+
+  bool references(double const* p)   const { return data.data() == p; }
+  bool reads_across(double const*)   const { return false; }
+
+  VectorRef ref() const { return {data.data(), data.size()}; }
+
+private:
+  // The single fused loop; expr is a local copy, so writes to out cannot
+  // change the pointers it holds. GCC vectorizes it at -O3 (or at -O2 with
+  // -fvect-cost-model=dynamic), checking at run time that out does not
+  // partially overlap an operand.
+  template <class E>
+  void evaluate(E const& expr, std::size_t first, std::size_t last) {
+    double* out = data.data();
+    for (std::size_t i = first; i < last; ++i)
+      out[i] = expr[i];
+  }
+
+  std::vector<double> data;
+};
+
+// Vectors enter expressions as views; other nodes by value
+template <class E>
+auto operand(VecExpr<E> const& e) {
+  if constexpr (std::is_same_v<E, Vector>)
+    return e.derived().ref();
+  else
+    return e.derived();
+}
+
+template <class L, class R>
+auto operator+(VecExpr<L> const& l, VecExpr<R> const& r)
+{
+  return Binary<decltype(operand(l)), decltype(operand(r)), std::plus<>>{operand(l), operand(r)};
+}
+
+template <class L, class R>
+auto operator-(VecExpr<L> const& l, VecExpr<R> const& r)
+{
+  return Binary<decltype(operand(l)), decltype(operand(r)), std::minus<>>{operand(l), operand(r)};
+}
+
+template <class L, class R>
+auto operator*(VecExpr<L> const& l, VecExpr<R> const& r)
+{
+  return Binary<decltype(operand(l)), decltype(operand(r)), std::multiplies<>>{operand(l), operand(r)};
+}
+
+template <class R>
+auto operator*(double s, VecExpr<R> const& r)
+{
+  return Binary<Scalar, decltype(operand(r)), std::multiplies<>>{Scalar{s, r.size()}, operand(r)};
+}
+
+template <class E>
+auto reverse(VecExpr<E> const& e)
+{
+  return Reverse<decltype(operand(e))>{operand(e)};
+}
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Client code: the same formula for both vector types
+template <class V>
+void client(V& a, V const& b, V const& c, V const& d, V const& e)
+{
+  a = b + c * d - 2.0 * e;
+}
 
 int main()
 {
-  
-}
\ No newline at end of file
+  // Client usage, including an assignment that reads its target
+  // out of order
+  Vector a(5), b(5, 1.0);
+  for (std::size_t i = 0; i < a.size(); ++i)
+    a[i] = static_cast<double>(i);
+  a = reverse(a) + b;
+  std::cout << "reverse(a) + b =";
+  for (std::size_t i = 0; i < a.size(); ++i)
+    std::cout << " " << a[i];
+  std::cout << std::endl;
+
+  // Benchmark
+  std::cout << "\nBenchmark: a = b + c * d - 2.0 * e (" << std::thread::hardware_concurrency()
+            << " hardware threads)" << std::endl;
+
+  for (std::size_t n : {std::size_t{1} << 10, std::size_t{1} << 20, std::size_t{1} << 24}) {
+    int const reps = static_cast<int>(std::max<std::size_t>(1, (std::size_t{1} << 27) / n));
+
+    naive::Vector na(n), nb(n, 1.0), nc(n, 2.0), nd(n, 3.0), ne(n, 0.5);
+    Vector        ea(n), eb(n, 1.0), ec(n, 2.0), ed(n, 3.0), ee(n, 0.5);
+
+    double t_naive = time_ms([&] {
+      for (int r = 0; r < reps; ++r)
+        client(na, nb, nc, nd, ne);
+    });
+    double t_serial = time_ms([&] {
+      for (int r = 0; r < reps; ++r)
+        ea.assign(eb + ec * ed - 2.0 * ee, Eval::serial);
+    });
+    double t_auto = time_ms([&] {
+      for (int r = 0; r < reps; ++r)
+        client(ea, eb, ec, ed, ee);
+    });
+
+    std::cout << "n = " << n << ", " << reps << " reps: naive " << t_naive
+              << " ms, fused serial " << t_serial << " ms, fused automatic " << t_auto
+              << " ms (" << (n >= Vector::parallel_threshold ? "parallel" : "serial") << ")"
+              << ", results " << na[n - 1] << " " << ea[n - 1] << std::endl;
+  }
+}
@@ -1,5 +1,526 @@
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+//
+// Example classes (unchanged by the mixins)
+
+struct Resource {
+  int x{5};
+  int y{7};
+};
+
+struct Widget {
+public:
+  Widget() = default;
+
+  Widget(int i, std::string s, Resource p)
+    : idx{i}, str{s}, ptr{std::make_unique<Resource>(p)} { }
+
+  Widget(Widget const& other)
+    : idx{other.idx}
+    , str{other.str}
+    , ptr{other.ptr ? std::make_unique<Resource>(*other.ptr) : nullptr}
+  { }
+
+  Widget& operator=(Widget const& other) {
+    Widget tmp{other};
+    swap(tmp);
+    return *this;
+  }
+
+  Widget(Widget&& other) = default;
+  Widget& operator=(Widget&& other) = default;
+  ~Widget() = default;
+
+  void swap(Widget& other) noexcept {
+    using std::swap;
+    swap(idx, other.idx);
+    swap(str, other.str);
+    swap(ptr, other.ptr);
+  }
+
+  int         get_idx() const { return idx; }
+  std::string get_str() const { return str; }
+  Resource*   get_ptr() const { return ptr.get(); }
+
+private:
+  int idx{};
+  std::string str{};
+  std::unique_ptr<Resource> ptr{};
+};
+
+class Rational {
+public:
+  Rational() = default;
+  Rational(int n)        : num{n}         { }
+  Rational(int n, int d) : num{n}, den{d} { normalize(); }
+
+  int get_num() const { return num; }
+  int get_den() const { return den; }
+
+  Rational& operator+=(Rational const& other) {
+    num = num * other.den + other.num * den;
+    den = den * other.den;
+    normalize();
+    return *this;
+  }
+
+  Rational& operator+=(int other) { return *this += Rational{other}; }
+
+private:
+  void normalize() {
+    assert(den != 0);
+    if (num == 0)
+      den = 1;
+    else if (den < 0) {
+      num = -num;
+      den = -den;
+    }
+    int n = gcd(num, den);
+    num /= n;
+    den /= n;
+  }
+
+  static int gcd(int a, int b) {
+    int n = std::abs(a);
+    while (b != 0) {
+      int tmp = n % b;
+      n = b;
+      b = tmp;
+    }
+    return n;
+  }
+
+  int num{0};
+  int den{1};
+};
+
+//
+// Instrumentation mixins
+
+// Each mixin is a class template that derives from the class it extends
+// (Mixin<Base> : Base), so capabilities stack as Counted<AllocTracked<T>>
+// without touching T and without virtual functions. The second parameter
+// turns the capability off: the disabled specialization has no data
+// members and no code beyond forwarding, so it costs nothing.
+namespace mixin {
+
+// N counters per Tag and thread. Only the owning thread writes its block,
+// so an increment is a relaxed load and store; read() sums all blocks,
+// including those of threads that have exited.
+template <class Tag, std::size_t N>
+class ThreadCounters {
+public:
+  static void add(std::size_t i, std::uint64_t v) {
+    auto& c = local().values[i];
+    c.store(c.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+  }
+
+  static std::array<std::uint64_t, N> read() {
+    std::array<std::uint64_t, N> sum{};
+    auto& r = registry();
+    std::lock_guard lock{r.mutex};
+    for (auto const& b : r.blocks)
+      for (std::size_t i = 0; i < N; ++i)
+        sum[i] += b->values[i].load(std::memory_order_relaxed);
+    return sum;
+  }
+
+private:
+  struct Block {
+    std::array<std::atomic<std::uint64_t>, N> values{};
+  };
+
+  struct Registry {
+    std::mutex                          mutex;
+    std::vector<std::unique_ptr<Block>> blocks;
+  };
+
+  static Registry& registry() {
+    static Registry r;
+    return r;
+  }
+
+  static Block& local() {
+    thread_local Block& block = [] () -> Block& {
+      auto& r = registry();
+      std::lock_guard lock{r.mutex};
+      r.blocks.push_back(std::make_unique<Block>());
+      return *r.blocks.back();
+    }();
+    return block;
+  }
+};
+
+inline std::uint64_t elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - start).count());
+}
+
+//
+// Instance counting
+
+struct InstanceStats {
+  std::uint64_t created{0};
+  std::uint64_t destroyed{0};
+
+  std::int64_t live() const { return static_cast<std::int64_t>(created - destroyed); }
+};
+
+// Counts every construction (including copies and moves) and destruction
+template <class Base, bool Enabled = true>
+class Counted : public Base {
+public:
+  template <class... Args>
+    requires std::is_constructible_v<Base, Args...>
+  Counted(Args&&... args) : Base(std::forward<Args>(args)...) { Counters::add(0, 1); }
+
+  Counted(Counted const& other) : Base(other) { Counters::add(0, 1); }
+  Counted(Counted&& other) noexcept(std::is_nothrow_move_constructible_v<Base>)
+    : Base(std::move(other)) { Counters::add(0, 1); }
+
+  Counted& operator=(Counted const&) = default;
+  Counted& operator=(Counted&&)      = default;
+
+  ~Counted() { Counters::add(1, 1); }
+
+  static InstanceStats instance_stats() {
+    auto c = Counters::read();
+    return {c[0], c[1]};
+  }
+
+private:
+  using Counters = ThreadCounters<Counted, 2>;   // created, destroyed
+};
+
+template <class Base>
+class Counted<Base, false> : public Base {
+public:
+  using Base::Base;
+
+  static InstanceStats instance_stats() { return {}; }
+};
+
+//
+// Allocation tracking
+
+struct AllocStats {
+  std::uint64_t allocations{0};
+  std::uint64_t deallocations{0};
+  std::uint64_t bytes{0};
+  std::uint64_t bytes_freed{0};
+};
+
+// Class-specific operator new/delete record every heap allocation of the
+// object itself (new T, new T[n]); memory its members allocate is not
+// included. They are kept out of line: once inlined, GCC matches the
+// global ::operator new against the class operator delete and reports a
+// false -Wmismatched-new-delete.
+template <class Base, bool Enabled = true>
+class AllocTracked : public Base {
+public:
+  using Base::Base;
+
+  [[gnu::noinline]] static void* operator new(std::size_t n) {
+    record(0, 2, n);
+    return ::operator new(n);
+  }
+
+  [[gnu::noinline]] static void* operator new[](std::size_t n) {
+    record(0, 2, n);
+    return ::operator new[](n);
+  }
+
+  [[gnu::noinline]] static void operator delete(void* p, std::size_t n) noexcept {
+    record(1, 3, n);
+    ::operator delete(p, n);
+  }
+
+  [[gnu::noinline]] static void operator delete[](void* p, std::size_t n) noexcept {
+    record(1, 3, n);
+    ::operator delete[](p, n);
+  }
+
+  static AllocStats alloc_stats() {
+    auto c = Counters::read();
+    return {c[0], c[1], c[2], c[3]};
+  }
+
+private:
+  using Counters = ThreadCounters<AllocTracked, 4>;   // allocations, deallocations, bytes, bytes freed
+
+  static void record(std::size_t count, std::size_t bytes, std::size_t n) {
+    Counters::add(count, 1);
+    Counters::add(bytes, n);
+  }
+};
+
+template <class Base>
+class AllocTracked<Base, false> : public Base {
+public:
+  using Base::Base;
+
+  static AllocStats alloc_stats() { return {}; }
+};
+
+//
+// Access timing
+
+struct AccessStats {
+  std::uint64_t accesses{0};
+  std::uint64_t total_ns{0};
+
+  double mean_ns() const { return accesses ? static_cast<double>(total_ns) / static_cast<double>(accesses) : 0; }
+};
+
+// obj->f() times the call to f: operator-> returns a probe that starts the
+// clock, and the probe's destructor stops it at the end of the full
+// expression. Direct calls (obj.f()) are not timed.
+template <class Base, bool Enabled = true>
+class Timed : public Base {
+public:
+  using Base::Base;
+
+  template <class T>
+  class Probe {
+  public:
+    explicit Probe(T* obj) : obj{obj} { }
+    ~Probe() {
+      Counters::add(0, 1);
+      Counters::add(1, elapsed_ns(start));
+    }
+
+    Probe(Probe const&)            = delete;
+    Probe& operator=(Probe const&) = delete;
+
+    T* operator->() const { return obj; }
+
+  private:
+    T*                                    obj;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  };
+
+  Probe<Base>       operator->()       { return Probe<Base>{this}; }
+  Probe<Base const> operator->() const { return Probe<Base const>{this}; }
+
+  static AccessStats access_stats() {
+    auto c = Counters::read();
+    return {c[0], c[1]};
+  }
+
+private:
+  using Counters = ThreadCounters<Timed, 2>;   // accesses, nanoseconds
+};
+
+template <class Base>
+class Timed<Base, false> : public Base {
+public:
+  using Base::Base;
+
+  Base*       operator->()       { return this; }
+  Base const* operator->() const { return this; }
+
+  static AccessStats access_stats() { return {}; }
+};
+
+//
+// Contention statistics
+
+struct ContentionStats {
+  std::uint64_t acquisitions{0};
+  std::uint64_t contended{0};   // had to wait for another thread
+  std::uint64_t wait_ns{0};
+};
+
+// Adds a mutex and lock(), which returns a handle that holds the lock and
+// gives access to the object: obj.lock()->f(). With statistics enabled an
+// acquisition first tries the lock, and only a failed try is timed.
+template <class Base, bool Enabled = true>
+class Synchronized : public Base {
+public:
+  using Base::Base;
+
+  Synchronized(Synchronized const& other) : Base(other) { }
+  Synchronized& operator=(Synchronized const& other) {
+    Base::operator=(other);
+    return *this;
+  }
+
+  class Locked {
+  public:
+    Locked(Base* obj, std::unique_lock<std::mutex> lock) : obj{obj}, lock{std::move(lock)} { }
+    Base* operator->() const { return obj; }
+
+  private:
+    Base*                        obj;
+    std::unique_lock<std::mutex> lock;
+  };
+
+  Locked lock() {
+    if constexpr (Enabled) {
+      Counters::add(0, 1);
+      std::unique_lock lock{mutex, std::try_to_lock};
+      if (not lock) {
+        auto start = std::chrono::steady_clock::now();
+        lock.lock();
+        Counters::add(1, 1);
+        Counters::add(2, elapsed_ns(start));
+      }
+      return {this, std::move(lock)};
+    }
+    else {
+      return {this, std::unique_lock{mutex}};
+    }
+  }
+
+  static ContentionStats contention_stats() {
+    if constexpr (Enabled) {
+      auto c = Counters::read();
+      return {c[0], c[1], c[2]};
+    }
+    else {
+      return {};
+    }
+  }
+
+private:
+  using Counters = ThreadCounters<Synchronized, 3>;   // acquisitions, contended, nanoseconds
+
+  std::mutex mutex;
+};
+
+} // namespace mixin
+
+// Disabled mixins add nothing to the object
+static_assert(sizeof(mixin::Counted<Widget, false>)      == sizeof(Widget));
+static_assert(sizeof(mixin::AllocTracked<Widget, false>) == sizeof(Widget));
+static_assert(sizeof(mixin::Timed<Rational, false>)      == sizeof(Rational));
+static_assert(sizeof(mixin::Counted<Rational>)           == sizeof(Rational));
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+template <class W>
+double widget_churn(std::size_t n)
+{
+  return time_ms([&] {
+    for (std::size_t i = 0; i < n; ++i) {
+      auto* w = new W{static_cast<int>(i), "widget", Resource{1, 2}};
+      W copy{*w};
+      delete w;
+    }
+  });
+}
+
+template <class R>
+double rational_access(R& r, std::size_t n)
+{
+  return time_ms([&] {
+    for (std::size_t i = 0; i < n; ++i)
+      r->operator+=(i % 2 ? -1 : 1);
+  });
+}
+
+template <class S>
+double contended_updates(S& r, std::size_t threads, std::size_t n)
+{
+  return time_ms([&] {
+    std::vector<std::jthread> workers;
+    for (std::size_t t = 0; t < threads; ++t)
+      workers.emplace_back([&] {
+        for (std::size_t i = 0; i < n; ++i)
+          r.lock()->operator+=(i % 2 ? -1 : 1);
+      });
+  });
+}
 
 int main()
 {
-  
-}
\ No newline at end of file
+  using TrackedWidget = mixin::Counted<mixin::AllocTracked<Widget>>;
+  using TimedRational = mixin::Timed<mixin::Counted<Rational>>;
+
+  // Client usage
+  {
+    auto* w1 = new TrackedWidget{1, "yo", Resource{0, 1}};
+    TrackedWidget w2{*w1};
+    TrackedWidget w3{std::move(w2)};
+    std::thread t{[] { TrackedWidget{2, "thread", Resource{}}; }};
+    t.join();
+    delete w1;
+
+    auto i = TrackedWidget::instance_stats();
+    auto a = TrackedWidget::alloc_stats();
+    std::cout << "Widget: " << i.created << " created, " << i.destroyed << " destroyed, "
+              << i.live() << " live; " << a.allocations << " heap allocations ("
+              << a.bytes << " bytes), " << a.deallocations << " freed" << std::endl;
+
+    TimedRational r{1, 2};
+    r->operator+=(Rational{1, 3});
+    r->operator+=(1);
+    auto s = TimedRational::access_stats();
+    std::cout << "Rational: " << r->get_num() << "/" << r->get_den() << " after "
+              << s.accesses << " timed accesses, " << s.mean_ns() << " ns on average" << std::endl;
+  }
+
+  // Benchmark
+  std::size_t const n = 1'000'000;
+
+  double t_plain = widget_churn<Widget>(n);
+  double t_off   = widget_churn<mixin::Counted<mixin::AllocTracked<Widget, false>, false>>(n);
+  double t_on    = widget_churn<TrackedWidget>(n);
+
+  std::cout << "\nBenchmark: " << n << " new/copy/delete of Widget"
+            << "\nplain:             " << t_plain << " ms"
+            << "\nmixins disabled:   " << t_off   << " ms"
+            << "\ncount + alloc:     " << t_on    << " ms" << std::endl;
+
+  std::size_t const m = 10'000'000;
+  mixin::Timed<Rational, false> r_off{0};
+  mixin::Timed<Rational>        r_on{0};
+  double a_off = rational_access(r_off, m);
+  double a_on  = rational_access(r_on, m);
+
+  std::cout << "\nBenchmark: " << m << " Rational += through operator->"
+            << "\ntiming disabled:   " << a_off << " ms"
+            << "\ntiming enabled:    " << a_on  << " ms ("
+            << mixin::Timed<Rational>::access_stats().mean_ns() << " ns per access measured)" << std::endl;
+
+  std::size_t const threads = 4;
+  std::size_t const k       = 1'000'000;
+  mixin::Synchronized<Rational, false> s_off{0};
+  mixin::Synchronized<Rational>        s_on{0};
+  double c_off = contended_updates(s_off, threads, k);
+  double c_on  = contended_updates(s_on, threads, k);
+  auto c = mixin::Synchronized<Rational>::contention_stats();
+
+  std::cout << "\nBenchmark: " << threads << " threads x " << k << " locked Rational +="
+            << "\nstatistics disabled: " << c_off << " ms"
+            << "\nstatistics enabled:  " << c_on  << " ms ("
+            << c.contended << " of " << c.acquisitions << " acquisitions contended, "
+            << c.wait_ns / 1'000'000 << " ms total wait)"
+            << "\nresults: " << s_off.lock()->get_num() << " " << s_on.lock()->get_num() << std::endl;
+}
@@ -1,5 +1,301 @@
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+//
+// Small-buffer type-erased callable
+
+namespace erased {
+
+enum class Copy { disabled, enabled };
+
+template <class Signature, std::size_t Size = 32, Copy C = Copy::enabled>
+class Function;
+
+// Holds any callable with the given signature. A target that fits in Size
+// bytes (and moves without throwing) is stored inline, so creating and
+// moving it does not allocate; larger targets go to the heap. Instead of a
+// virtual base class, each target type T gets one static table of function
+// pointers, and the wrapper stores a pointer to it. With Copy::disabled the
+// wrapper is move-only and accepts move-only targets.
+template <class R, class... Args, std::size_t Size, Copy C>
+class Function<R(Args...), Size, C> {
+public:
+  Function() = default;
+
+  template <class F, class T = std::decay_t<F>>
+    requires (not std::is_same_v<T, Function>)
+         and std::is_invocable_r_v<R, T&, Args...>
+         and (C == Copy::disabled or std::is_copy_constructible_v<T>)
+  Function(F&& f) {
+    if constexpr (fits_inline<T>)
+      ::new (static_cast<void*>(storage)) T(std::forward<F>(f));
+    else
+      ::new (static_cast<void*>(storage)) T*(new T(std::forward<F>(f)));
+    vtable = &vtable_for<T, fits_inline<T>>;
+  }
+
+  Function(Function const& other) requires (C == Copy::enabled) {
+    if (other.vtable) {
+      other.vtable->copy(other.storage, storage);
+      vtable = other.vtable;
+    }
+  }
+
+  Function(Function&& other) noexcept {
+    if (other.vtable) {
+      other.vtable->move(other.storage, storage);
+      vtable = std::exchange(other.vtable, nullptr);
+    }
+  }
+
+  Function& operator=(Function const& other) requires (C == Copy::enabled) {
+    Function tmp{other};
+    return *this = std::move(tmp);
+  }
+
+  Function& operator=(Function&& other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other.vtable) {
+        other.vtable->move(other.storage, storage);
+        vtable = std::exchange(other.vtable, nullptr);
+      }
+    }
+    return *this;
+  }
+
+  ~Function() { reset(); }
+
+  // Like std::function, calls the target as non-const; throws
+  // std::bad_function_call if empty
+  R operator()(Args... args) const {
+    if (not vtable)
+      throw std::bad_function_call{};
+    return vtable->call(const_cast<std::byte*>(storage), std::forward<Args>(args)...);
+  }
+
+  explicit operator bool() const { return vtable != nullptr; }
+
+  // Whether the target lives in the small buffer
+  bool is_inline() const { return vtable and vtable->local; }
+
+  void reset() noexcept {
+    if (vtable)
+      std::exchange(vtable, nullptr)->destroy(storage);
+  }
+
+private:
+  struct VTable {
+    R    (*call)(void* self, Args&&... args);
+    void (*copy)(void const* from, void* to);   // null for move-only wrappers
+    void (*move)(void* from, void* to) noexcept;   // leaves from destroyed
+    void (*destroy)(void* self) noexcept;
+    bool local;
+  };
+
+  template <class T>
+  static constexpr bool fits_inline = sizeof(T) <= Size
+                                  and alignof(T) <= alignof(std::max_align_t)
+                                  and std::is_nothrow_move_constructible_v<T>;
+
+  // The object itself for inline targets, a pointer to it otherwise
+  template <class T, bool Local>
+  static T& target(void* self) {
+    if constexpr (Local)
+      return *std::launder(static_cast<T*>(self));
+    else
+      return **std::launder(static_cast<T**>(self));
+  }
+
+  template <class T, bool Local>
+  static constexpr VTable make_vtable() {
+    VTable v{};
+    v.call = [](void* self, Args&&... args) -> R {
+      return std::invoke(target<T, Local>(self), std::forward<Args>(args)...);
+    };
+    if constexpr (C == Copy::enabled) {
+      v.copy = [](void const* from, void* to) {
+        T& src = target<T, Local>(const_cast<void*>(from));
+        if constexpr (Local)
+          ::new (to) T(src);
+        else
+          ::new (to) T*(new T(src));
+      };
+    }
+    v.move = [](void* from, void* to) noexcept {
+      if constexpr (Local) {
+        T& src = target<T, Local>(from);
+        ::new (to) T(std::move(src));
+        src.~T();
+      }
+      else {
+        ::new (to) T*(&target<T, Local>(from));
+      }
+    };
+    v.destroy = [](void* self) noexcept {
+      if constexpr (Local)
+        target<T, Local>(self).~T();
+      else
+        delete &target<T, Local>(self);
+    };
+    v.local = Local;
+    return v;
+  }
+
+  template <class T, bool Local>
+  static constexpr VTable vtable_for = make_vtable<T, Local>();
+
+  VTable const*                       vtable{nullptr};
+  alignas(std::max_align_t) std::byte storage[Size < sizeof(void*) ? sizeof(void*) : Size];
+};
+
+} // namespace erased
+
+//
+// Example callables
+
+struct Affine {
+  double a, b;
+  double operator()(double x) const { return a * x + b; }
+};
+
+struct Quadratic {
+  double a, b, c;
+  double operator()(double x) const { return (a * x + b) * x + c; }
+};
+
+struct Clamp {
+  double lo, hi, scale;
+  double operator()(double x) const { return x < lo ? lo : x > hi ? hi : x * scale; }
+};
+
+// The classic alternative: an interface and a heap-allocated implementation
+namespace inheritance {
+
+struct Kernel {
+  virtual ~Kernel() = default;
+  virtual double operator()(double x) const = 0;
+};
+
+template <class F>
+struct KernelImpl : Kernel {
+  explicit KernelImpl(F f) : f{f} { }
+  double operator()(double x) const override { return f(x); }
+  F f;
+};
+
+} // namespace inheritance
+
+using Kernel = erased::Function<double(double)>;
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Builds the i-th kernel of a mixed sequence with make(callable)
+template <class Make>
+auto make_kernel(std::size_t i, Make make)
+{
+  double const p = static_cast<double>(i % 10) * 0.1;
+  switch (i % 3) {
+    case 0:  return make(Affine{p, 1.0});
+    case 1:  return make(Quadratic{p, 0.5, -1.0});
+    default: return make(Clamp{-p, p, 0.5});
+  }
+}
+
+template <class W, class Make, class Call>
+void run(char const* name, std::size_t n, int reps, Make make, Call call)
+{
+  std::vector<W> kernels;
+  double t_create = time_ms([&] {
+    for (int r = 0; r < reps; ++r) {
+      kernels.clear();
+      for (std::size_t i = 0; i < n; ++i)
+        kernels.push_back(make_kernel(i, make));
+    }
+  });
+
+  double sum = 0;
+  double t_call = time_ms([&] {
+    for (int r = 0; r < reps; ++r) {
+      double x = static_cast<double>(r % 7) * 0.25;
+      for (auto& k : kernels)
+        sum += call(k, x);
+    }
+  });
+
+  std::cout << name << "create " << t_create << " ms, call " << t_call << " ms (sum " << sum << ")" << std::endl;
+}
+
+// Client code: any callable, including move-only ones
+void client()
+{
+  Kernel small = Affine{2.0, 1.0};
+  Kernel large = [q = Quadratic{1.0, 0.0, 0.0}, pad = std::array<double, 8>{}] (double x) { return q(x) + pad[0]; };
+  Kernel copy  = large;
+  std::cout << "small(3) = " << small(3.0) << (small.is_inline() ? " (inline)" : " (heap)")
+            << ", copy of large(3) = " << copy(3.0) << (copy.is_inline() ? " (inline)" : " (heap)") << std::endl;
+
+  erased::Function<int(), 32, erased::Copy::disabled> owner = [p = std::make_unique<int>(42)] { return *p; };
+  auto moved = std::move(owner);
+  std::cout << "move-only target: " << moved() << ", moved-from is " << (owner ? "set" : "empty") << std::endl;
+
+  try {
+    owner();
+  }
+  catch (std::bad_function_call const&) {
+    std::cout << "calling an empty Function throws std::bad_function_call" << std::endl;
+  }
+}
 
 int main()
 {
-  
-}
\ No newline at end of file
+  // Client usage
+  client();
+
+  // Benchmark
+  std::size_t const n    = 1'000;
+  int         const reps = 10'000;
+  std::cout << "\nBenchmark: " << reps << " x " << n << " kernels (sizes " << sizeof(Affine) << ", "
+            << sizeof(Quadratic) << ", " << sizeof(Clamp) << " bytes)" << std::endl;
+
+  // libstdc++'s std::function keeps at most 16 bytes inline, so it and
+  // unique_ptr allocate for most kernels; erased::Function and std::variant
+  // never do
+  run<Kernel>("erased::Function:   ", n, reps,
+    [](auto f) { return Kernel{f}; },
+    [](Kernel const& k, double x) { return k(x); });
+
+  using StdFunction = std::function<double(double)>;
+  run<StdFunction>("std::function:      ", n, reps,
+    [](auto f) { return StdFunction{f}; },
+    [](StdFunction const& k, double x) { return k(x); });
+
+  using Pointer = std::unique_ptr<inheritance::Kernel>;
+  run<Pointer>("unique_ptr<Kernel>: ", n, reps,
+    [](auto f) -> Pointer { return std::make_unique<inheritance::KernelImpl<decltype(f)>>(f); },
+    [](Pointer const& k, double x) { return (*k)(x); });
+
+  using Variant = std::variant<Affine, Quadratic, Clamp>;
+  run<Variant>("std::variant:       ", n, reps,
+    [](auto f) { return Variant{f}; },
+    [](Variant const& k, double x) { return std::visit([x](auto const& f) { return f(x); }, k); });
+}
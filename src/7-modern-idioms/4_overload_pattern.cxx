@@ -1,5 +1,322 @@
+#include <array>
+#include <cassert>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+//
+// Overload pattern
+
+template <class... Fs>
+struct overloaded : Fs... {
+  using Fs::operator()...;
+};
+
+//
+// Events
+
+struct Trade     { std::uint32_t symbol; std::uint32_t qty; double price; };
+struct Quote     { std::uint32_t symbol; double bid; double ask; };
+struct Heartbeat { std::uint64_t seq; };
+struct Cancel    { std::uint64_t order; };
+
+using Event = std::variant<Trade, Quote, Heartbeat, Cancel>;
+
+//
+// Event bus
+
+namespace bus {
+
+// A handler set built from any number of callables. Every event is passed
+// to each callable that accepts its type, in the order given; a callable
+// that accepts none of them (e.g. an overloaded with no matching case) is
+// skipped at compile time. Both the selection and the calls are resolved
+// statically, so they inline.
+template <class... Fs>
+struct Subscribers {
+  std::tuple<Fs...> fs;
+
+  template <class E>
+  void operator()(E const& e) {
+    std::apply([&](auto&... f) { (call_if_accepted(f, e), ...); }, fs);
+  }
+
+private:
+  template <class F, class E>
+  static void call_if_accepted(F& f, E const& e) {
+    if constexpr (std::is_invocable_v<F&, E const&>)
+      f(e);
+  }
+};
+
+template <class... Fs>
+Subscribers<Fs...> subscribe(Fs... fs)
+{
+  return {{std::move(fs)...}};
+}
+
+// Events are published into a ring of variants in one contiguous array and
+// delivered by dispatch(), which sorts the pending events by alternative
+// first and then hands each alternative's batch to the handlers in a loop
+// of its own. Within a batch the event type, and therefore the handler, is
+// fixed, so there is no per-event indirect branch. Events of one type are
+// delivered in publication order; the relative order of different types is
+// not kept (dispatch_in_order() keeps it, with one std::visit per event).
+// Handlers may publish: the slots of the events being dispatched are only
+// released once the dispatch is over, so new events go to free slots and
+// are delivered by the next dispatch.
+template <class Event, class Handlers, std::size_t Capacity = std::size_t{1} << 16>
+class EventBus {
+  static_assert(std::has_single_bit(Capacity), "Capacity must be a power of two");
+  static_assert(Capacity <= UINT32_MAX);
+
+public:
+  static constexpr std::size_t alternatives = std::variant_size_v<Event>;
+
+  explicit EventBus(Handlers h)
+    : handlers{std::move(h)}, slots{std::make_unique<Event[]>(Capacity)}
+  {
+    for (auto& b : batches)
+      b.reserve(Capacity);
+  }
+
+  // Returns false (and drops e) when the ring is full
+  template <class E>
+  bool publish(E&& e) {
+    if (tail - head == Capacity)
+      return false;
+    slots[tail++ & (Capacity - 1)] = std::forward<E>(e);
+    return true;
+  }
+
+  std::size_t pending() const { return tail - head; }
+
+  // If a handler throws, the rest of this dispatch's events are dropped
+  void dispatch() {
+    assert(not dispatching && "dispatch() called from a handler");
+    std::size_t const end = tail;
+    for (auto& b : batches)
+      b.clear();
+    for (std::size_t i = head; i != end; ++i) {
+      auto slot = static_cast<std::uint32_t>(i & (Capacity - 1));
+      auto type = slots[slot].index();
+      if (type != std::variant_npos)
+        batches[type].push_back(slot);
+    }
+
+    struct Release {
+      EventBus&   bus;
+      std::size_t end;
+      ~Release() {
+        bus.head        = end;
+        bus.dispatching = false;
+      }
+    } release{*this, end};
+    dispatching = true;
+    dispatch_batches(std::make_index_sequence<alternatives>{});
+  }
+
+  // The naive alternative: one std::visit per event
+  void dispatch_in_order() {
+    for (; head != tail; ++head)
+      std::visit(handlers, slots[head & (Capacity - 1)]);
+  }
+
+private:
+  template <std::size_t... I>
+  void dispatch_batches(std::index_sequence<I...>) {
+    (dispatch_batch<I>(), ...);
+  }
+
+  template <std::size_t I>
+  void dispatch_batch() {
+    for (auto slot : batches[I])
+      handlers(*std::get_if<I>(&slots[slot]));
+  }
+
+  Handlers                                             handlers;
+  std::unique_ptr<Event[]>                             slots;
+  std::size_t                                          head{0};   // next event to deliver
+  std::size_t                                          tail{0};   // next free slot
+  bool                                                 dispatching{false};
+  std::array<std::vector<std::uint32_t>, alternatives> batches;   // slots by alternative
+};
+
+} // namespace bus
+
+//
+// Virtual message hierarchy (for comparison)
+
+struct Totals {
+  std::uint64_t volume{0};
+  double        notional{0};
+  double        spread{0};
+  std::uint64_t last_seq{0};
+  std::uint64_t cancels{0};
+};
+
+namespace oop {
+
+struct Message {
+  virtual ~Message() = default;
+  virtual void apply(Totals& t) const = 0;
+};
+
+struct TradeMessage : Message {
+  explicit TradeMessage(Trade e) : e{e} { }
+  void apply(Totals& t) const override { t.volume += e.qty; t.notional += e.price * e.qty; }
+  Trade e;
+};
+
+struct QuoteMessage : Message {
+  explicit QuoteMessage(Quote e) : e{e} { }
+  void apply(Totals& t) const override { t.spread += e.ask - e.bid; }
+  Quote e;
+};
+
+struct HeartbeatMessage : Message {
+  explicit HeartbeatMessage(Heartbeat e) : e{e} { }
+  void apply(Totals& t) const override { t.last_seq = e.seq; }
+  Heartbeat e;
+};
+
+struct CancelMessage : Message {
+  explicit CancelMessage(Cancel e) : e{e} { }
+  void apply(Totals& t) const override { ++t.cancels; }
+  Cancel e;
+};
+
+} // namespace oop
+
+// The same work as the oop::Message overrides, as an overload set
+auto totals_handler(Totals& t)
+{
+  return overloaded{
+    [&t](Trade const& e)     { t.volume += e.qty; t.notional += e.price * e.qty; },
+    [&t](Quote const& e)     { t.spread += e.ask - e.bid; },
+    [&t](Heartbeat const& e) { t.last_seq = e.seq; },
+    [&t](Cancel const&)      { ++t.cancels; }
+  };
+}
+
+//
+// Benchmark
+
+template <class F>
+double time_ms(F&& f)
+{
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto stop  = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// A random mix of event types, so that the type of the next event cannot
+// be predicted
+std::vector<Event> make_stream(std::size_t n)
+{
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<int> type{0, 3};
+  std::vector<Event> events;
+  for (std::size_t i = 0; i < n; ++i) {
+    auto k = static_cast<std::uint32_t>(i);
+    switch (type(rng)) {
+      case 0:  events.emplace_back(Trade{k % 100, k % 7 + 1, 100.0 + k % 13}); break;
+      case 1:  events.emplace_back(Quote{k % 100, 99.5, 100.5});               break;
+      case 2:  events.emplace_back(Heartbeat{i});                              break;
+      default: events.emplace_back(Cancel{i});                                 break;
+    }
+  }
+  return events;
+}
+
+std::unique_ptr<oop::Message> make_message(Event const& e)
+{
+  return std::visit(overloaded{
+    [](Trade const& e)     -> std::unique_ptr<oop::Message> { return std::make_unique<oop::TradeMessage>(e); },
+    [](Quote const& e)     -> std::unique_ptr<oop::Message> { return std::make_unique<oop::QuoteMessage>(e); },
+    [](Heartbeat const& e) -> std::unique_ptr<oop::Message> { return std::make_unique<oop::HeartbeatMessage>(e); },
+    [](Cancel const& e)    -> std::unique_ptr<oop::Message> { return std::make_unique<oop::CancelMessage>(e); }
+  }, e);
+}
+
+// Client code: three subscribers composed into one handler set
+void client()
+{
+  Totals        totals;
+  std::uint64_t seen = 0;
+  std::uint64_t big_trades = 0;
+
+  auto handlers = bus::subscribe(
+    totals_handler(totals),
+    [&](auto const&) { ++seen; },
+    [&](Trade const& t) { big_trades += t.qty >= 5; }
+  );
+  bus::EventBus<Event, decltype(handlers), 16> events{handlers};
+
+  events.publish(Trade{1, 10, 101.0});
+  events.publish(Quote{1, 100.0, 101.5});
+  events.publish(Trade{2, 2, 50.0});
+  events.publish(Heartbeat{7});
+  events.publish(Cancel{3});
+  std::cout << events.pending() << " events pending" << std::endl;
+  events.dispatch();
+
+  std::cout << "seen " << seen << ", volume " << totals.volume << ", notional " << totals.notional
+            << ", spread " << totals.spread << ", heartbeat " << totals.last_seq << ", cancels "
+            << totals.cancels << ", large trades " << big_trades << std::endl;
+}
 
 int main()
 {
-  
-}
\ No newline at end of file
+  // Client usage
+  client();
+
+  // Benchmark: the bus is refilled from the same stream before every
+  // dispatch; only delivery is timed
+  constexpr std::size_t capacity = std::size_t{1} << 16;
+  int const reps = 150;
+  auto const stream = make_stream(capacity);
+
+  Totals t_visit, t_batch, t_virtual;
+  bus::EventBus<Event, decltype(totals_handler(t_visit)), capacity> naive{totals_handler(t_visit)};
+  bus::EventBus<Event, decltype(totals_handler(t_batch)), capacity> batched{totals_handler(t_batch)};
+
+  double ms_visit = 0, ms_batch = 0;
+  for (int r = 0; r < reps; ++r) {
+    for (auto const& e : stream)
+      naive.publish(e);
+    ms_visit += time_ms([&] { naive.dispatch_in_order(); });
+
+    for (auto const& e : stream)
+      batched.publish(e);
+    ms_batch += time_ms([&] { batched.dispatch(); });
+  }
+
+  std::vector<std::unique_ptr<oop::Message>> messages;
+  for (auto const& e : stream)
+    messages.push_back(make_message(e));
+  double ms_virtual = time_ms([&] {
+    for (int r = 0; r < reps; ++r)
+      for (auto const& m : messages)
+        m->apply(t_virtual);
+  });
+
+  double const events = static_cast<double>(capacity) * reps;
+  auto rate = [&](double ms) { return events / ms / 1e3; };
+  std::cout << "\nBenchmark: " << events << " events of 4 types in random order"
+            << "\nvirtual messages:     " << ms_virtual << " ms (" << rate(ms_virtual) << " M events/s)"
+            << "\nstd::visit per event: " << ms_visit  << " ms (" << rate(ms_visit)   << " M events/s)"
+            << "\nbatched by type:      " << ms_batch   << " ms (" << rate(ms_batch)   << " M events/s)"
+            << "\nchecks: " << t_virtual.volume << " " << t_visit.volume << " " << t_batch.volume
+            << " " << t_virtual.cancels << " " << t_visit.cancels << " " << t_batch.cancels << std::endl;
+}